@@ -0,0 +1,345 @@
+// Load generator for ClipboardService.
+//
+// Every history size runs in a fresh child process (the service is a
+// process-wide singleton) against a throw-away data directory. The child
+// seeds the database, starts the service the same way the shell does and
+// then pushes synthetic clipboard events through QClipboard, timing each
+// event until the history model reflects it.
+//
+//   clipboard_bench [--sizes 100,1000,10000,100000]
+
+#include <QClipboard>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QMimeData>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "clipboard.hpp"
+#include "clipboard_store.hpp"
+#include "fast_hash.hpp"
+
+namespace {
+constexpr int kTextEvents = 300;
+constexpr int kDuplicateEvents = 300;
+constexpr int kDuplicateSet = 16;
+constexpr int kRichEvents = 100;
+constexpr int kLargeEvents = 20;
+constexpr int kLargeChars = 2 * 1024 * 1024;
+constexpr int kImageEvents = 20;
+constexpr int kBursts = 10;
+constexpr int kBurstSize = 100;
+constexpr int kBurstCoalesceMs = 50;
+constexpr int kEventTimeoutMs = 10000;
+
+struct PhaseResult {
+    const char* name;
+    QList<qint64> latenciesUs;
+    qint64 blockedUs = 0;
+    qint64 maxStallUs = 0;
+    int timeouts = 0;
+};
+
+// Measures how long the GUI thread fails to service a 1 ms timer. Anything
+// beyond the interval is time the event loop was busy with other work.
+class StallMonitor {
+public:
+    StallMonitor() {
+        m_timer.setTimerType(Qt::PreciseTimer);
+        m_timer.setInterval(1);
+        QObject::connect(&m_timer, &QTimer::timeout, [this] { tick(); });
+    }
+
+    void restart() {
+        m_blockedUs = 0;
+        m_maxStallUs = 0;
+        m_clock.start();
+        m_lastUs = 0;
+        m_timer.start();
+    }
+
+    void stop() {
+        tick();
+        m_timer.stop();
+    }
+
+    qint64 blockedUs() const { return m_blockedUs; }
+    qint64 maxStallUs() const { return m_maxStallUs; }
+
+private:
+    void tick() {
+        const qint64 now = m_clock.nsecsElapsed() / 1000;
+        const qint64 stall = now - m_lastUs - 1000;
+        m_lastUs = now;
+        if (stall <= 1000) return;
+        m_blockedUs += stall;
+        m_maxStallUs = std::max(m_maxStallUs, stall);
+    }
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastUs = 0;
+    qint64 m_blockedUs = 0;
+    qint64 m_maxStallUs = 0;
+};
+
+QString fillerText(const QString& head, int chars) {
+    static const QString lorem = QStringLiteral(
+        "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor. ");
+    QString text = head;
+    text.reserve(chars);
+    while (text.size() < chars) {
+        text += lorem;
+    }
+    text.truncate(chars);
+    return text;
+}
+
+QImage noiseImage(int seed) {
+    QImage image(1024, 768, QImage::Format_ARGB32);
+    quint32 state = 2463534242u ^ quint32(seed * 2654435761u);
+    for (int y = 0; y < image.height(); ++y) {
+        auto* line = reinterpret_cast<quint32*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            line[x] = 0xff000000u | (state & 0x00ffffffu);
+        }
+    }
+    return image;
+}
+
+// Blocks in a nested event loop until the model reports a change, which is
+// when the user would see the copy land in the list.
+bool waitForModel(ClipboardModel* model) {
+    QEventLoop loop;
+    bool changed = false;
+    auto done = [&] {
+        changed = true;
+        loop.quit();
+    };
+    QObject::connect(model, &QAbstractItemModel::rowsInserted, &loop, done);
+    QObject::connect(model, &QAbstractItemModel::rowsMoved, &loop, done);
+    QObject::connect(model, &QAbstractItemModel::dataChanged, &loop, done);
+    QTimer::singleShot(kEventTimeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    return changed;
+}
+
+template <typename Emit>
+void runSequential(PhaseResult& result, StallMonitor& monitor, ClipboardModel* model,
+                   int events, Emit emitEvent) {
+    monitor.restart();
+    QElapsedTimer timer;
+    for (int i = 0; i < events; ++i) {
+        timer.start();
+        emitEvent(i);
+        if (waitForModel(model)) {
+            result.latenciesUs.append(timer.nsecsElapsed() / 1000);
+        } else {
+            ++result.timeouts;
+        }
+    }
+    monitor.stop();
+    result.blockedUs = monitor.blockedUs();
+    result.maxStallUs = monitor.maxStallUs();
+}
+
+qint64 percentile(QList<qint64> values, double p) {
+    if (values.isEmpty()) return 0;
+    std::sort(values.begin(), values.end());
+    const qsizetype rank = qsizetype(std::ceil(p * values.size()));
+    return values[std::clamp<qsizetype>(rank - 1, 0, values.size() - 1)];
+}
+
+qint64 directorySize(const QString& path) {
+    qint64 total = 0;
+    QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        total += it.nextFileInfo().size();
+    }
+    return total;
+}
+
+double ms(qint64 us) {
+    return us / 1000.0;
+}
+
+double mib(qint64 bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void printPhase(const PhaseResult& r) {
+    std::printf("  %-10s %6lld %9.2f %9.2f %9.2f %9.2f %11.1f %10.2f %5d\n", r.name,
+                static_cast<long long>(r.latenciesUs.size()),
+                ms(percentile(r.latenciesUs, 0.50)), ms(percentile(r.latenciesUs, 0.90)),
+                ms(percentile(r.latenciesUs, 0.99)), ms(percentile(r.latenciesUs, 1.0)),
+                ms(r.blockedUs), ms(r.maxStallUs), r.timeouts);
+}
+
+void seedHistory(const QString& dataDir, int history) {
+    ClipboardStore store;
+    store.open(dataDir + "/clipboard.db", ClipboardService::imageDirectory());
+    store.setMaxEntries(history + 100000);
+    for (int i = 0; i < history; ++i) {
+        const QString text = fillerText(QStringLiteral("seed %1 ").arg(i), 200);
+        store.storeText(text, FastHash::toHex(clipboardTextDigest(text)), {});
+    }
+    // The destructor commits everything that is still pending.
+}
+
+int runChild(QGuiApplication& app, int history) {
+    const QString dataDir = ClipboardService::dataDirectory();
+
+    QElapsedTimer seedTimer;
+    seedTimer.start();
+    seedHistory(dataDir, history);
+    const qint64 seedMs = seedTimer.elapsed();
+
+    ClipboardService* service = ClipboardService::create(nullptr, nullptr);
+    service->setParent(&app);
+    service->setMaxEntries(history + 100000);
+    service->setMaxBytes(64ll * 1024 * 1024 * 1024);
+    service->setCoalesceInterval(0);
+
+    QElapsedTimer initTimer;
+    initTimer.start();
+    service->init();
+    const qint64 initUs = initTimer.nsecsElapsed() / 1000;
+
+    if (service->startupReadyMs() < 0) {
+        QEventLoop loop;
+        QObject::connect(service, &ClipboardService::startupMetricsChanged, &loop, &QEventLoop::quit);
+        QTimer::singleShot(60000, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+
+    ClipboardModel* model = service->model();
+    QClipboard* clipboard = QGuiApplication::clipboard();
+    StallMonitor monitor;
+
+    PhaseResult text{"text"};
+    QStringList recent;
+    runSequential(text, monitor, model, kTextEvents, [&](int i) {
+        const QString value = fillerText(QStringLiteral("bench %1 ").arg(i), 80);
+        if (i >= kTextEvents - kDuplicateSet) recent.append(value);
+        clipboard->setText(value);
+    });
+
+    PhaseResult duplicate{"duplicate"};
+    runSequential(duplicate, monitor, model, kDuplicateEvents, [&](int i) {
+        clipboard->setText(recent[i % recent.size()]);
+    });
+
+    // Rich copies carry text/html and a uri list next to the plain text; the
+    // HTML body repeats so the blobs are shared between entries.
+    PhaseResult rich{"rich"};
+    runSequential(rich, monitor, model, kRichEvents, [&](int i) {
+        auto* data = new QMimeData();
+        data->setText(QStringLiteral("rich %1").arg(i));
+        data->setHtml(fillerText(QStringLiteral("<p>rich %1</p>").arg(i % 8), 4096));
+        data->setData("text/uri-list", QStringLiteral("file:///tmp/rich-%1\r\n").arg(i).toUtf8());
+        clipboard->setMimeData(data);
+    });
+
+    QStringList largeTexts;
+    for (int i = 0; i < kLargeEvents; ++i) {
+        largeTexts.append(fillerText(QStringLiteral("large %1 ").arg(i), kLargeChars));
+    }
+    PhaseResult large{"large"};
+    runSequential(large, monitor, model, kLargeEvents, [&](int i) {
+        clipboard->setText(largeTexts[i]);
+    });
+    largeTexts.clear();
+
+    QList<QImage> images;
+    for (int i = 0; i < kImageEvents; ++i) {
+        images.append(noiseImage(i));
+    }
+    PhaseResult image{"image"};
+    runSequential(image, monitor, model, kImageEvents, [&](int i) {
+        clipboard->setImage(images[i]);
+    });
+
+    // Selection storms: with coalescing on, each burst should collapse into a
+    // single stored entry. Latency covers the whole burst.
+    service->setCoalesceInterval(kBurstCoalesceMs);
+    PhaseResult burst{"burst"};
+    runSequential(burst, monitor, model, kBursts, [&](int b) {
+        for (int i = 0; i < kBurstSize; ++i) {
+            clipboard->setText(QStringLiteral("burst %1 selection %2").arg(b).arg(i));
+        }
+    });
+
+    const QString dbPath = dataDir + "/clipboard.db";
+    const qint64 dbBytes = QFileInfo(dbPath).size() + QFileInfo(dbPath + "-wal").size();
+    const qint64 imageBytes = directorySize(ClipboardService::imageDirectory());
+
+    std::printf("history %d: seed %lld ms, init() %.2f ms, snapshot shown %lld ms, db ready %lld ms\n",
+                history, static_cast<long long>(seedMs), ms(initUs),
+                static_cast<long long>(service->startupSnapshotMs()),
+                static_cast<long long>(service->startupReadyMs()));
+    std::printf("  %-10s %6s %9s %9s %9s %9s %11s %10s %5s\n", "phase", "events", "p50 ms",
+                "p90 ms", "p99 ms", "max ms", "blocked ms", "stall ms", "lost");
+    for (const PhaseResult* r : {&text, &duplicate, &rich, &large, &image, &burst}) {
+        printPhase(*r);
+    }
+    std::printf("  storage: db %.1f MiB, images %.1f MiB, %lld rows, %.1f MiB accounted\n\n",
+                mib(dbBytes), mib(imageBytes), static_cast<long long>(service->storedEntries()),
+                mib(service->storageBytes()));
+    std::fflush(stdout);
+    return 0;
+}
+
+int runParent(const QStringList& sizes) {
+    for (const QString& size : sizes) {
+        QProcess child;
+        child.setProcessChannelMode(QProcess::ForwardedChannels);
+        child.start(QCoreApplication::applicationFilePath(), {"--child", size.trimmed()});
+        if (!child.waitForFinished(-1) || child.exitCode() != 0) {
+            std::fprintf(stderr, "history %s: benchmark run failed\n", qPrintable(size));
+            return 1;
+        }
+    }
+    return 0;
+}
+}
+
+int main(int argc, char* argv[]) {
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    // Keep the run away from the real history: AppDataLocation resolves
+    // under XDG_DATA_HOME, which points at a private temporary directory.
+    QTemporaryDir dataHome;
+    qputenv("XDG_DATA_HOME", dataHome.path().toLocal8Bit());
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("noon-clipboard-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ClipboardService load generator");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma separated history sizes.", "list",
+                                   "100,1000,10000,100000");
+    QCommandLineOption childOption("child", "Run a single history size.", "history");
+    childOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOption(sizesOption);
+    parser.addOption(childOption);
+    parser.process(app);
+
+    if (parser.isSet(childOption)) {
+        return runChild(app, parser.value(childOption).toInt());
+    }
+    return runParent(parser.value(sizesOption).split(',', Qt::SkipEmptyParts));
+}
@@ -0,0 +1,179 @@
+// Cost of one ResourcesService collection tick against a synthetic procfs.
+//
+// For every process count a throw-away tree is laid out like the real
+// /proc (stat and per-pid stat files). Between ticks a share of the pids
+// accumulate CPU time, some exit and new ones appear, so the per-pid table
+// sees the same churn as a live system.
+//
+//   resources_bench [--pids 500,2000,10000] [--ticks 200] [--top 10]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sys/resource.h>
+#include "resources_cpu.hpp"
+#include "resources_processes.hpp"
+
+namespace {
+constexpr int kCores = 16;
+constexpr double kBusyShare = 0.05;
+constexpr double kChurnShare = 0.01;
+
+struct FakeProcess {
+    int pid = 0;
+    quint64 ticks = 0;
+    quint64 startTime = 0;
+    quint64 rssPages = 0;
+};
+
+void writeFile(const QString& path, const QByteArray& contents) {
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(contents);
+    }
+}
+
+void writeProcess(const QString& proc, const FakeProcess& p) {
+    QDir().mkpath(QStringLiteral("%1/%2").arg(proc).arg(p.pid));
+    const QByteArray stat = QStringLiteral(
+        "%1 (worker %1) S 1 %1 %1 0 -1 4194560 1200 0 3 0 %2 %3 0 0 20 0 4 0 %4 %5 %6 "
+        "18446744073709551615 1 1 0 0 0 0 0 4096 17663 0 0 0 17 3 0 0 0 0 0\n")
+        .arg(p.pid).arg(p.ticks / 2).arg(p.ticks - p.ticks / 2).arg(p.startTime)
+        .arg(p.rssPages * 8 * 4096).arg(p.rssPages).toLatin1();
+    writeFile(QStringLiteral("%1/%2/stat").arg(proc).arg(p.pid), stat);
+}
+
+void writeProcStat(const QString& proc, quint64 tick) {
+    QByteArray stat = QByteArray("cpu  ") + QByteArray::number(tick * kCores * 3)
+        + " 0 " + QByteArray::number(tick * kCores) + " " + QByteArray::number(tick * kCores * 6)
+        + " 10 0 5 0 0 0\n";
+    for (int i = 0; i < kCores; ++i) {
+        stat += "cpu" + QByteArray::number(i) + " " + QByteArray::number(tick * 3) + " 0 "
+            + QByteArray::number(tick) + " " + QByteArray::number(tick * 6) + " 1 0 0 0 0 0\n";
+    }
+    stat += "intr 0\nctxt 0\nbtime 0\nprocesses 0\n";
+    writeFile(proc + "/stat", stat);
+}
+
+qint64 percentile(QList<qint64> values, double p) {
+    if (values.isEmpty()) return 0;
+    std::sort(values.begin(), values.end());
+    const qsizetype rank = qsizetype(std::ceil(p * values.size()));
+    return values[std::clamp<qsizetype>(rank - 1, 0, values.size() - 1)];
+}
+
+qint64 cpuTimeUs() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+        + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+int run(int pidCount, int ticks, int top) {
+    QTemporaryDir root;
+    const QString proc = root.path() + "/proc";
+    QDir().mkpath(proc);
+
+    QRandomGenerator rng(pidCount);
+    QList<FakeProcess> processes;
+    int nextPid = 100;
+    for (int i = 0; i < pidCount; ++i) {
+        FakeProcess p;
+        p.pid = nextPid++;
+        p.startTime = quint64(p.pid) * 10;
+        p.rssPages = rng.bounded(1, 100000);
+        processes.append(p);
+        writeProcess(proc, p);
+    }
+    writeProcStat(proc, 0);
+
+    const SysRoot sysRoot(root.path());
+    ProcessCollector collector(sysRoot, top);
+    CpuCollector cpu(sysRoot);
+    ProcessSample sample;
+    CpuSample cpuSample;
+    QList<qint64> processUs;
+    QList<qint64> cpuUs;
+    qint64 collectorCpuUs = 0;
+
+    for (int tick = 0; tick < ticks; ++tick) {
+        // Mutate the tree outside of the measured region.
+        const int busy = qMax(1, int(pidCount * kBusyShare));
+        for (int i = 0; i < busy; ++i) {
+            FakeProcess& p = processes[rng.bounded(processes.size())];
+            p.ticks += rng.bounded(1, 200);
+            writeProcess(proc, p);
+        }
+        const int churn = int(pidCount * kChurnShare);
+        for (int i = 0; i < churn; ++i) {
+            const int index = rng.bounded(processes.size());
+            QDir(QStringLiteral("%1/%2").arg(proc).arg(processes[index].pid)).removeRecursively();
+            FakeProcess p;
+            p.pid = nextPid++;
+            p.startTime = quint64(p.pid) * 10;
+            p.rssPages = rng.bounded(1, 100000);
+            processes[index] = p;
+            writeProcess(proc, p);
+        }
+        writeProcStat(proc, quint64(tick) + 1);
+
+        const qint64 cpuBefore = cpuTimeUs();
+        QElapsedTimer timer;
+        timer.start();
+        collector.collect(sample);
+        processUs.append(timer.nsecsElapsed() / 1000);
+        timer.restart();
+        cpu.collect(cpuSample);
+        cpuUs.append(timer.nsecsElapsed() / 1000);
+        collectorCpuUs += cpuTimeUs() - cpuBefore;
+    }
+
+    std::printf("%8d %6d %9lld %9lld %9lld %9lld %9lld %10.1f %8d\n", pidCount, ticks,
+                static_cast<long long>(percentile(processUs, 0.50)),
+                static_cast<long long>(percentile(processUs, 0.99)),
+                static_cast<long long>(percentile(processUs, 1.0)),
+                static_cast<long long>(percentile(cpuUs, 0.50)),
+                static_cast<long long>(percentile(cpuUs, 0.99)),
+                double(collectorCpuUs) / ticks, collector.trackedCount());
+    return sample.processCount == pidCount ? 0 : 1;
+}
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("noon-resources-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ResourcesService collector benchmark");
+    parser.addHelpOption();
+    QCommandLineOption pidsOption("pids", "Comma separated process counts.", "list", "500,2000,10000");
+    QCommandLineOption ticksOption("ticks", "Collection ticks per run.", "count", "200");
+    QCommandLineOption topOption("top", "Size of the top lists.", "count", "10");
+    parser.addOption(pidsOption);
+    parser.addOption(ticksOption);
+    parser.addOption(topOption);
+    parser.process(app);
+
+    std::printf("%8s %6s %9s %9s %9s %9s %9s %10s %8s\n", "pids", "ticks", "proc p50", "proc p99",
+                "proc max", "cpu p50", "cpu p99", "cpu us/tk", "tracked");
+    std::printf("%8s %6s %9s %9s %9s %9s %9s %10s %8s\n", "", "", "(us)", "(us)", "(us)", "(us)",
+                "(us)", "", "");
+
+    int status = 0;
+    const int ticks = parser.value(ticksOption).toInt();
+    const int top = parser.value(topOption).toInt();
+    for (const QString& count : parser.value(pidsOption).split(',', Qt::SkipEmptyParts)) {
+        if (run(count.trimmed().toInt(), ticks, top) != 0) {
+            std::fprintf(stderr, "pids %s: process count mismatch\n", qPrintable(count));
+            status = 1;
+        }
+    }
+    return status;
+}
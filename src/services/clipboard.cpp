@@ -1,27 +1,56 @@
 #include "clipboard.hpp"
 #include <QGuiApplication>
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QStandardPaths>
-#include <QDir>
-#include <QDateTime>
-#include <QFileInfo>
-#include <QCryptographicHash>
-#include <QBuffer>
+#include <QDebug>
+#include "fast_hash.hpp"
+#include "clipboard_snapshot.hpp"
+#include <algorithm>
+
+namespace {
+constexpr auto kPngMime = "image/png";
+
+// Formats above this size are not worth keeping next to the main payload.
+constexpr qsizetype kMaxFormatBytes = 32 * 1024 * 1024;
+
+// Every extra format the source offers, as raw bytes. The main text or image
+// payload and Qt's synthetic formats are left out.
+QList<ClipboardFormat> captureFormats(const QMimeData* mimeData, bool image) {
+    QList<ClipboardFormat> formats;
+    const QStringList offered = mimeData->formats();
+    for (const QString& mime : offered) {
+        if (!mime.contains('/') || mime.startsWith("text/plain")
+            || mime == "application/x-qt-image" || mime == ClipboardMimeData::MarkerFormat) {
+            continue;
+        }
+        if (image && mime.startsWith("image/")) continue;
+
+        const QByteArray data = mimeData->data(mime);
+        if (data.isEmpty() || data.size() > kMaxFormatBytes) continue;
+        formats.append({mime, data});
+    }
+    return formats;
+}
+}
 
 ClipboardService::ClipboardService(QObject* parent)
     : QObject(parent)
     , m_clipboard(QGuiApplication::clipboard())
-    , m_reloadTimer(new QTimer(this))
+    , m_model(new ClipboardModel(this))
+    , m_searchModel(new ClipboardModel(this))
+    , m_coalesceTimer(new QTimer(this))
 {
-    m_reloadTimer->setSingleShot(true);
-    m_reloadTimer->setInterval(50);
-    connect(m_reloadTimer, &QTimer::timeout, this, &ClipboardService::performScheduledReload);
+    m_coalesceTimer->setSingleShot(true);
+    connect(m_coalesceTimer, &QTimer::timeout, this, &ClipboardService::ingestClipboard);
 }
 
 ClipboardService::~ClipboardService() {
-    if (m_db.isOpen()) {
-        m_db.close();
+    if (m_searchThread) {
+        m_searchThread->quit();
+        m_searchThread->wait();
+    }
+    if (m_storeThread) {
+        m_storeThread->quit();
+        m_storeThread->wait();
     }
 }
 
@@ -30,312 +59,567 @@ void ClipboardService::init() {
         return;
     }
 
-    initDatabase();
-    loadHistory();
-    connect(m_clipboard, &QClipboard::dataChanged, this, &ClipboardService::onClipboardChanged);
+    m_startupTimer.start();
+
+    qRegisterMetaType<ClipboardEntry>();
+    qRegisterMetaType<QList<ClipboardEntry>>();
+    qRegisterMetaType<ClipboardFormat>();
+    qRegisterMetaType<QList<ClipboardFormat>>();
+
+    if (m_shared) {
+        m_peer = new ClipboardPeer(this);
+        connect(m_peer, &ClipboardPeer::snapshotChanged, this, &ClipboardService::onSharedSnapshot);
+        connect(m_peer, &ClipboardPeer::ownerLost, this, &ClipboardService::onOwnerLost);
+        connect(m_peer, &ClipboardPeer::requestReceived, this, &ClipboardService::onPeerRequest);
+        connect(m_peer, &ClipboardPeer::formatRequested, this, &ClipboardService::onPeerFormatRequest);
+        connect(m_peer, &ClipboardPeer::searchRequested, this, &ClipboardService::onPeerSearch);
+        connect(m_peer, &ClipboardPeer::formatReceived, this, &ClipboardService::formatReady);
+        connect(m_peer, &ClipboardPeer::resultsReceived, this, &ClipboardService::onSearchResults);
+
+        if (!m_peer->elect()) {
+            // Another process owns the history; rows arrive through its
+            // shared snapshot and this process never opens the database.
+            onSharedSnapshot();
+            m_startupSnapshotMs = m_startupTimer.elapsed();
+            m_initialized = true;
+            return;
+        }
+    }
 
+    startOwner();
     m_initialized = true;
 }
 
-void ClipboardService::initDatabase() {
-    QString dbPath = QStandardPaths::writableLocation(
-        QStandardPaths::AppDataLocation) + "/clipboard.db";
-    QDir().mkpath(QFileInfo(dbPath).path());
+void ClipboardService::startOwner() {
+    if (m_peer) {
+        startPublishing();
+    }
 
-    m_db = QSqlDatabase::addDatabase("QSQLITE", "clipboard_connection");
-    m_db.setDatabaseName(dbPath);
+    QString dataDir = dataDirectory();
 
-    if (!m_db.open()) {
-        return;
+    // Show the last known history straight away; the database is opened and
+    // migrated on the store thread and its first page reconciled afterwards.
+    QList<ClipboardEntry> warm;
+    if (ClipboardSnapshot::read(dataDir + "/clipboard_snapshot.bin", warm)) {
+        m_model->reconcile(warm);
+        for (int i = warm.size() - 1; i >= 0; --i) {
+            rememberEntry(warm[i]);
+        }
+        emit entriesRefreshed();
     }
+    m_startupSnapshotMs = m_startupTimer.elapsed();
+
+    m_storeThread = new QThread(this);
+    m_storeThread->setObjectName("ClipboardStore");
+    m_store = new ClipboardStore();
+    m_store->moveToThread(m_storeThread);
+
+    connect(m_storeThread, &QThread::finished, m_store, &QObject::deleteLater);
+    connect(m_store, &ClipboardStore::pageLoaded, this, &ClipboardService::onPageLoaded);
+    connect(m_store, &ClipboardStore::contentReady, this, &ClipboardService::onContentReady);
+    connect(m_store, &ClipboardStore::formatReady, this, &ClipboardService::onFormatReady);
+    connect(m_model, &ClipboardModel::moreRequested, this, [this](qint64 beforeTimestamp, int beforeId) {
+        QMetaObject::invokeMethod(m_store, "loadPage", Q_ARG(qint64, beforeTimestamp),
+                                  Q_ARG(int, beforeId), Q_ARG(int, kPageSize));
+    });
+    connect(m_store, &ClipboardStore::entryStored, this, &ClipboardService::onEntryStored);
+    connect(m_store, &ClipboardStore::entryRemoved, this, &ClipboardService::onEntryRemoved);
+    connect(m_store, &ClipboardStore::wiped, this, &ClipboardService::onWiped);
+    connect(m_store, &ClipboardStore::storageChanged, this, &ClipboardService::onStorageChanged);
+
+    m_storeThread->start();
+
+    m_searchThread = new QThread(this);
+    m_searchThread->setObjectName("ClipboardSearch");
+    m_searcher = new ClipboardSearcher(dataDir + "/clipboard.db");
+    m_searcher->moveToThread(m_searchThread);
+
+    connect(m_searchThread, &QThread::finished, m_searcher, &QObject::deleteLater);
+    connect(m_searcher, &ClipboardSearcher::resultsReady, this, &ClipboardService::onSearchResults);
+
+    m_searchThread->start();
+
+    QMetaObject::invokeMethod(m_store, "open",
+                              Q_ARG(QString, dataDir + "/clipboard.db"),
+                              Q_ARG(QString, imageDirectory()));
+    QMetaObject::invokeMethod(m_store, "setMaxEntries", Q_ARG(int, m_maxEntries));
+    QMetaObject::invokeMethod(m_store, "setMaxBytes", Q_ARG(qint64, m_maxBytes));
+    QMetaObject::invokeMethod(m_store, "loadPage", Q_ARG(qint64, 0), Q_ARG(int, -1),
+                              Q_ARG(int, kPageSize));
 
-    QSqlQuery query(m_db);
-
-    query.exec(R"(
-        CREATE TABLE IF NOT EXISTS clipboard_history (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            type TEXT NOT NULL,
-            content TEXT,
-            content_hash TEXT,
-            image_path TEXT,
-            timestamp INTEGER NOT NULL
-        )
-    )");
-
-    QSqlQuery checkColumn(m_db);
-    checkColumn.exec("PRAGMA table_info(clipboard_history)");
-    bool hasHashColumn = false;
-    while (checkColumn.next()) {
-        if (checkColumn.value(1).toString() == "content_hash") {
-            hasHashColumn = true;
-            break;
-        }
+    connect(m_clipboard, &QClipboard::dataChanged, this, &ClipboardService::onClipboardChanged);
+}
+
+bool ClipboardService::isSecondary() const {
+    return m_peer && !m_peer->isOwner();
+}
+
+void ClipboardService::startPublishing() {
+    m_publishTimer = new QTimer(this);
+    m_publishTimer->setSingleShot(true);
+    m_publishTimer->setInterval(kPublishDelayMs);
+    connect(m_publishTimer, &QTimer::timeout, this, &ClipboardService::publishSnapshot);
+
+    auto schedule = [this] {
+        if (!m_publishTimer->isActive()) m_publishTimer->start();
+    };
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, schedule);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, schedule);
+    connect(m_model, &QAbstractItemModel::rowsMoved, this, schedule);
+    connect(m_model, &QAbstractItemModel::dataChanged, this, schedule);
+    connect(m_model, &QAbstractItemModel::modelReset, this, schedule);
+    connect(this, &ClipboardService::storageChanged, this, schedule);
+}
+
+void ClipboardService::publishSnapshot() {
+    QList<ClipboardEntry> head;
+    const int count = qMin(m_model->count(), ClipboardSnapshot::MaxEntries);
+    head.reserve(count);
+    for (int row = 0; row < count; ++row) {
+        head.append(*m_model->entryAt(row));
     }
+    m_peer->publish(head, m_storedEntries, m_storageBytes);
+}
 
-    if (!hasHashColumn) {
-        query.exec("ALTER TABLE clipboard_history ADD COLUMN content_hash TEXT");
+void ClipboardService::onSharedSnapshot() {
+    if (!isSecondary()) return;
+
+    QList<ClipboardEntry> entries;
+    qint64 storedEntries = 0;
+    qint64 storageBytes = 0;
+    if (!m_peer->readSnapshot(entries, storedEntries, storageBytes)) return;
+
+    m_model->reconcile(entries);
+    m_model->setHasMore(false);
+    onStorageChanged(storedEntries, storageBytes);
+
+    if (m_startupReadyMs < 0) {
+        m_startupReadyMs = m_startupTimer.elapsed();
+        emit startupMetricsChanged();
     }
+}
 
-    query.exec("CREATE INDEX IF NOT EXISTS idx_timestamp ON clipboard_history(timestamp DESC)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_hash ON clipboard_history(content_hash)");
+void ClipboardService::onOwnerLost() {
+    // Replies to a forwarded search died with the old owner.
+    setSearching(false);
+    if (!m_peer->elect()) return;
+
+    // The previous owner went away and this process won the election.
+    qInfo() << "Clipboard history: taking over as owner";
+    startOwner();
+    emit ownerChanged();
 }
 
-void ClipboardService::loadHistory() {
-    if (m_isProcessing) {
+void ClipboardService::onPeerRequest(const QByteArray& command, int id) {
+    if (command == "wipe") {
+        wipe();
         return;
     }
 
-    m_isProcessing = true;
-
-    QStringList oldEntries = m_entries;
-    m_entries.clear();
-    m_fullEntries.clear();
-
-    QSqlQuery query(m_db);
-    query.prepare("SELECT * FROM clipboard_history ORDER BY timestamp DESC LIMIT :limit");
-    query.bindValue(":limit", m_maxEntries);
+    const int row = m_model->rowOfId(id);
+    if (row < 0) return;
+    if (command == "copy") {
+        copyByIndex(row);
+    } else if (command == "delete") {
+        deleteEntry(row);
+    }
+}
 
-    if (!query.exec()) {
-        m_isProcessing = false;
+void ClipboardService::onPeerFormatRequest(int client, int id, const QString& mime) {
+    if (!m_store) {
+        m_peer->sendFormat(client, id, mime, QString());
         return;
     }
+    m_peerFormats.append({client, id, mime});
+    QMetaObject::invokeMethod(m_store, "fetchFormat", Q_ARG(int, id), Q_ARG(QString, mime));
+}
+
+void ClipboardService::onFormatReady(int id, const QString& mime, const QString& text) {
+    for (qsizetype i = m_peerFormats.size() - 1; i >= 0; --i) {
+        const PeerFormat& request = m_peerFormats[i];
+        if (request.id != id || request.mime != mime) continue;
+        m_peer->sendFormat(request.client, id, mime, text);
+        m_peerFormats.removeAt(i);
+    }
+    emit formatReady(id, mime, text);
+}
 
-    while (query.next()) {
-        Entry entry;
-        entry.id = query.value("id").toInt();
-        entry.type = query.value("type").toString();
-        entry.content = query.value("content").toString();
-        entry.imagePath = query.value("image_path").toString();
-        entry.timestamp = query.value("timestamp").toLongLong();
+void ClipboardService::onPeerSearch(int client, int generation, const QString& query, int limit) {
+    if (!m_searcher) return;
+
+    // One searcher serves this process and its peers; whichever search it
+    // was running ends here with what it found so far.
+    finishPeerSearch();
+    setSearching(false);
+    const int latest = ++m_searchGeneration;
+    m_searcher->setLatestGeneration(latest);
+    m_peerSearch = {client, generation};
+    QMetaObject::invokeMethod(m_searcher, "run", Q_ARG(int, latest),
+                              Q_ARG(QString, query), Q_ARG(int, limit));
+}
 
-        m_fullEntries.append(entry);
+void ClipboardService::finishPeerSearch() {
+    if (m_peerSearch.client >= 0) {
+        m_peer->sendResults(m_peerSearch.client, m_peerSearch.generation, {}, true);
+        m_peerSearch = {};
+    }
+}
 
-        if (entry.type == "image") {
-            m_entries.append("Image");
-        } else {
-            QString displayText = entry.content;
-            displayText.replace('\n', ' ').replace('\t', ' ');
-            if (displayText.length() > 100) {
-                displayText = displayText.left(100) + "...";
-            }
-            m_entries.append(displayText);
+void ClipboardService::onPageLoaded(const QList<ClipboardEntry>& entries, bool reset, bool hasMore) {
+    if (reset) {
+        m_model->reconcile(entries);
+        m_recent.clear();
+        const int seeded = qMin<int>(entries.size(), ClipboardDedupeRing::Capacity);
+        for (int i = seeded - 1; i >= 0; --i) {
+            rememberEntry(entries[i]);
         }
+    } else {
+        m_model->append(entries);
     }
+    m_model->setHasMore(hasMore);
 
-    QSqlQuery cleanupQuery(m_db);
-    cleanupQuery.prepare(R"(
-        DELETE FROM clipboard_history
-        WHERE id NOT IN (
-            SELECT id FROM clipboard_history
-            ORDER BY timestamp DESC
-            LIMIT :limit
-        )
-    )");
-    cleanupQuery.bindValue(":limit", m_maxEntries);
-    cleanupQuery.exec();
+    // Appended pages are not announced, as documented on entries().
+    if (reset) {
+        emit entriesChanged();
+        emit entriesRefreshed();
+    }
 
-    m_isProcessing = false;
+    if (m_startupReadyMs < 0) {
+        m_startupReadyMs = m_startupTimer.elapsed();
+        qInfo() << "Clipboard history: snapshot shown in" << m_startupSnapshotMs
+                << "ms, database ready in" << m_startupReadyMs << "ms";
+        emit startupMetricsChanged();
+    }
+}
 
-    if (oldEntries != m_entries) {
-        emit entriesChanged();
+void ClipboardService::onContentReady(int id, const QString& content, const QVariantMap& formatFiles) {
+    if (id != m_pendingCopy.id) return;
+    const ClipboardEntry entry = m_pendingCopy;
+    m_pendingCopy = ClipboardEntry();
+
+    if (entry.type == "image") {
+        if (ClipboardMimeData* data = ClipboardMimeData::forImage(entry.imagePath, formatFiles)) {
+            m_clipboard->setMimeData(data);
+        }
+        return;
     }
-    emit entriesRefreshed();
+    m_clipboard->setMimeData(ClipboardMimeData::forText(content, formatFiles));
 }
 
-void ClipboardService::scheduleReload() {
-    if (!m_reloadTimer->isActive()) {
-        m_reloadTimer->start();
+void ClipboardService::onEntryStored(const ClipboardEntry& entry) {
+    rememberEntry(entry);
+
+    int row = m_model->rowOfId(entry.id);
+    if (row >= 0) {
+        m_model->moveToTop(row, entry);
+        return;
     }
+
+    m_model->prepend(entry);
+    m_model->truncate(m_maxEntries);
+}
+
+void ClipboardService::onEntryRemoved(int id) {
+    m_recent.removeId(id);
+    m_model->removeAt(m_model->rowOfId(id));
 }
 
-void ClipboardService::performScheduledReload() {
-    loadHistory();
+void ClipboardService::onWiped() {
+    m_recent.clear();
+    m_hasLastDigest = false;
+    m_model->clear();
+    emit entriesChanged();
+    emit entriesRefreshed();
+}
+
+void ClipboardService::onStorageChanged(qint64 entries, qint64 bytes) {
+    if (m_storedEntries == entries && m_storageBytes == bytes) return;
+    m_storedEntries = entries;
+    m_storageBytes = bytes;
+    emit storageChanged();
 }
 
 void ClipboardService::onClipboardChanged() {
-    if (m_ignoreNextChange) {
-        m_ignoreNextChange = false;
+    if (m_coalesceInterval <= 0) {
+        ingestClipboard();
         return;
     }
 
-    if (m_isProcessing) {
-        return;
+    // Selection storms fire many events per second; only the state at the
+    // end of each window is recorded.
+    if (!m_coalesceTimer->isActive()) {
+        m_coalesceTimer->start(m_coalesceInterval);
     }
+}
 
+void ClipboardService::ingestClipboard() {
     const QMimeData* mimeData = m_clipboard->mimeData();
-    if (!mimeData) return;
-
-    QString currentHash;
+    if (!mimeData || ClipboardMimeData::isOwn(mimeData)) return;
 
+    QList<ClipboardFormat> formats;
     if (mimeData->hasImage()) {
+        // PNG offered by the source is kept byte for byte; only other image
+        // types go through a QImage decode and re-encode.
+        const QByteArray png = mimeData->hasFormat(kPngMime) ? mimeData->data(kPngMime) : QByteArray();
+        if (!png.isEmpty()) {
+            quint64 digest = FastHash::hash(png.constData(), size_t(png.size()));
+            if (!isNewContent(digest, mimeData, true, formats)) {
+                return;
+            }
+
+            QMetaObject::invokeMethod(m_store, "storeEncodedImage", Q_ARG(QByteArray, png),
+                                      Q_ARG(QString, FastHash::toHex(digest)),
+                                      Q_ARG(QList<ClipboardFormat>, formats));
+            return;
+        }
+
         QImage image = qvariant_cast<QImage>(mimeData->imageData());
         if (!image.isNull()) {
-            QByteArray imageData;
-            QBuffer buffer(&imageData);
-            buffer.open(QIODevice::WriteOnly);
-            image.save(&buffer, "PNG");
-            currentHash = QString::fromLatin1(
-                QCryptographicHash::hash(imageData, QCryptographicHash::Md5).toHex()
-            );
-
-            if (currentHash == m_lastClipboardHash) {
+            quint64 digest = clipboardImageDigest(image);
+            if (!isNewContent(digest, mimeData, true, formats)) {
                 return;
             }
 
-            m_lastClipboardHash = currentHash;
-            storeImage(image);
+            QMetaObject::invokeMethod(m_store, "storeImage",
+                                      Q_ARG(QImage, image), Q_ARG(QString, FastHash::toHex(digest)),
+                                      Q_ARG(QList<ClipboardFormat>, formats));
         }
     } else if (mimeData->hasText()) {
         QString text = mimeData->text();
         if (!text.isEmpty()) {
-            currentHash = QString::fromLatin1(
-                QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Md5).toHex()
-            );
-
-            if (currentHash == m_lastClipboardHash) {
+            quint64 digest = clipboardTextDigest(text);
+            if (!isNewContent(digest, mimeData, false, formats)) {
                 return;
             }
 
-            m_lastClipboardHash = currentHash;
-            storeText(text);
+            QMetaObject::invokeMethod(m_store, "storeText",
+                                      Q_ARG(QString, text), Q_ARG(QString, FastHash::toHex(digest)),
+                                      Q_ARG(QList<ClipboardFormat>, formats));
         }
     }
 }
 
-void ClipboardService::storeText(const QString& text) {
-    QByteArray hash = QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha256).toHex();
-
-    QSqlQuery checkQuery(m_db);
-    checkQuery.prepare("SELECT id FROM clipboard_history WHERE content_hash = :hash AND type = 'text' LIMIT 1");
-    checkQuery.bindValue(":hash", QString::fromLatin1(hash));
+bool ClipboardService::isNewContent(quint64 digest, const QMimeData* mimeData, bool image,
+                                    QList<ClipboardFormat>& formats) {
+    if (m_hasLastDigest && digest == m_lastDigest) {
+        return false;
+    }
+    m_lastDigest = digest;
+    m_hasLastDigest = true;
 
-    if (checkQuery.exec() && checkQuery.next()) {
-        int existingId = checkQuery.value(0).toInt();
-        QSqlQuery updateQuery(m_db);
-        updateQuery.prepare("UPDATE clipboard_history SET timestamp = :timestamp WHERE id = :id");
-        updateQuery.bindValue(":timestamp", QDateTime::currentSecsSinceEpoch());
-        updateQuery.bindValue(":id", existingId);
+    // Extra formats are only transferred once the payload is known not to be
+    // an immediate repeat.
+    formats = captureFormats(mimeData, image);
 
-        if (updateQuery.exec()) {
-            scheduleReload();
-        }
-        return;
+    int id = m_recent.idFor(digest);
+    if (id < 0) {
+        return true;
     }
 
-    QSqlQuery query(m_db);
-    query.prepare(R"(
-        INSERT INTO clipboard_history (type, content, content_hash, timestamp)
-        VALUES ('text', :content, :hash, :timestamp)
-    )");
-    query.bindValue(":content", text);
-    query.bindValue(":hash", QString::fromLatin1(hash));
-    query.bindValue(":timestamp", QDateTime::currentSecsSinceEpoch());
+    // Known entry: bump it by id instead of looking the hash up again.
+    if (m_model->rowOfId(id) != 0) {
+        QMetaObject::invokeMethod(m_store, "touchEntry", Q_ARG(int, id),
+                                  Q_ARG(QList<ClipboardFormat>, formats));
+    }
+    return false;
+}
 
-    if (query.exec()) {
-        scheduleReload();
+void ClipboardService::rememberEntry(const ClipboardEntry& entry) {
+    bool ok = false;
+    quint64 digest = entry.hash.toULongLong(&ok, 16);
+    if (ok && entry.hash.size() == 16) {
+        m_recent.insert(digest, entry.id);
     }
 }
 
-void ClipboardService::storeImage(const QImage& image) {
-    QString imagePath = QStandardPaths::writableLocation(
-        QStandardPaths::AppDataLocation) + "/clipboard_images/";
-    QDir().mkpath(imagePath);
+void ClipboardService::setCoalesceInterval(int ms) {
+    if (ms < 0 || m_coalesceInterval == ms) return;
+    m_coalesceInterval = ms;
+    emit coalesceIntervalChanged();
+}
 
-    QString filename = QString::number(QDateTime::currentMSecsSinceEpoch()) + ".png";
-    QString fullPath = imagePath + filename;
+void ClipboardService::copyByIndex(int index) {
+    const ClipboardEntry* entry = m_model->entryAt(index);
+    if (!entry) return;
 
-    if (!image.save(fullPath)) {
+    if (isSecondary()) {
+        m_peer->sendRequest("copy", entry->id);
         return;
     }
 
-    QSqlQuery query(m_db);
-    query.prepare(R"(
-        INSERT INTO clipboard_history (type, image_path, timestamp)
-        VALUES ('image', :path, :timestamp)
-    )");
-    query.bindValue(":path", fullPath);
-    query.bindValue(":timestamp", QDateTime::currentSecsSinceEpoch());
+    copyEntry(*entry);
+}
 
-    if (query.exec()) {
-        scheduleReload();
-    } else {
-        QFile::remove(fullPath);
+void ClipboardService::copySearchResult(int index) {
+    const ClipboardEntry* entry = m_searchModel->entryAt(index);
+    if (!entry) return;
+
+    if (isSecondary()) {
+        m_peer->sendRequest("copy", entry->id);
+        return;
     }
+
+    copyEntry(*entry);
 }
 
-void ClipboardService::copyByIndex(int index) {
-    if (index < 0 || index >= m_fullEntries.size()) return;
+void ClipboardService::copyEntry(const ClipboardEntry& entry) {
+    // Plain images need nothing from the database.
+    if (entry.type == "image" && entry.formats.isEmpty()) {
+        m_pendingCopy = ClipboardEntry();
+        if (ClipboardMimeData* data = ClipboardMimeData::forImage(entry.imagePath)) {
+            m_clipboard->setMimeData(data);
+        }
+        return;
+    }
 
-    const Entry& entry = m_fullEntries[index];
-    m_ignoreNextChange = true;
+    if (!m_store) return;
+    m_pendingCopy = entry;
+    QMetaObject::invokeMethod(m_store, "fetchContent", Q_ARG(int, entry.id));
+}
 
-    if (entry.type == "image") {
-        QImage image(entry.imagePath);
-        if (!image.isNull()) {
-            m_clipboard->setImage(image);
-        } else {
-            m_ignoreNextChange = false;
+void ClipboardService::requestFormat(int index, const QString& mime) {
+    const ClipboardEntry* entry = m_model->entryAt(index);
+    if (!entry || !entry->formats.contains(mime)) return;
+
+    if (isSecondary()) {
+        // Answer right away when the owner cannot, so callers never hang.
+        if (!m_peer->requestFormat(entry->id, mime)) {
+            emit formatReady(entry->id, mime, QString());
         }
-    } else {
-        m_clipboard->setText(entry.content);
+        return;
     }
+    if (!m_store) return;
+
+    QMetaObject::invokeMethod(m_store, "fetchFormat", Q_ARG(int, entry->id), Q_ARG(QString, mime));
 }
 
 void ClipboardService::copy(const QString& text) {
-    m_ignoreNextChange = true;
-    m_lastClipboardHash.clear();
-    m_clipboard->setText(text, QClipboard::Clipboard);
+    m_hasLastDigest = false;
+    m_clipboard->setMimeData(ClipboardMimeData::forText(text), QClipboard::Clipboard);
 }
 
 void ClipboardService::deleteEntry(int index) {
-    if (index < 0 || index >= m_fullEntries.size()) return;
+    const ClipboardEntry* entry = m_model->entryAt(index);
+    if (!entry) return;
+
+    if (isSecondary()) {
+        m_peer->sendRequest("delete", entry->id);
+        return;
+    }
+    if (!m_store) return;
+
+    QMetaObject::invokeMethod(m_store, "removeEntry", Q_ARG(int, entry->id));
+}
+
+void ClipboardService::wipe() {
+    if (isSecondary()) {
+        m_peer->sendRequest("wipe");
+        return;
+    }
+    if (!m_store) return;
+    QMetaObject::invokeMethod(m_store, "wipe");
+}
 
-    const Entry& entry = m_fullEntries[index];
-    int entryId = entry.id;
-    QString imagePath = entry.imagePath;
-    QString type = entry.type;
+bool ClipboardService::isImage(int index) const {
+    const ClipboardEntry* entry = m_model->entryAt(index);
+    return entry && entry->type == "image";
+}
 
-    if (type == "image" && !imagePath.isEmpty()) {
-        QFile::remove(imagePath);
+QString ClipboardService::getImagePath(int index) const {
+    const ClipboardEntry* entry = m_model->entryAt(index);
+    if (entry && entry->type == "image") {
+        return entry->imagePath;
     }
+    return "";
+}
 
-    QSqlQuery query(m_db);
-    query.prepare("DELETE FROM clipboard_history WHERE id = :id");
-    query.bindValue(":id", entryId);
+QString ClipboardService::getThumbnail(int index) const {
+    const ClipboardEntry* entry = m_model->entryAt(index);
+    if (entry && entry->type == "image") {
+        return ClipboardImageProvider::urlForImage(entry->imagePath);
+    }
+    return "";
+}
 
-    if (query.exec()) {
-        scheduleReload();
+void ClipboardService::search(const QString& query, int limit) {
+    finishPeerSearch();
+    const int generation = ++m_searchGeneration;
+    if (m_searcher) {
+        m_searcher->setLatestGeneration(generation);
     }
+
+    const QString trimmed = query.trimmed();
+    if (trimmed.isEmpty() || limit <= 0) {
+        m_searchModel->clear();
+        setSearching(false);
+        return;
+    }
+
+    // Rank the already loaded rows first so results show up on this frame;
+    // the index query then streams in everything outside that window.
+    QList<QPair<int, int>> ranked;
+    for (int row = 0; row < m_model->count(); ++row) {
+        const ClipboardEntry* entry = m_model->entryAt(row);
+        if (entry->type != "text") continue;
+        int score = ClipboardSearcher::fuzzyScore(trimmed, entry->preview);
+        if (score >= 0) ranked.append({score, row});
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+
+    QList<ClipboardEntry> local;
+    for (const auto& [score, row] : std::as_const(ranked)) {
+        if (local.size() >= limit) break;
+        local.append(*m_model->entryAt(row));
+    }
+    m_searchModel->setEntries(local);
+
+    // Secondaries have no database; the owner streams the rest back.
+    if (isSecondary()) {
+        setSearching(m_peer->requestSearch(generation, trimmed, limit));
+        return;
+    }
+    if (!m_searcher) return;
+    setSearching(true);
+    QMetaObject::invokeMethod(m_searcher, "run", Q_ARG(int, generation),
+                              Q_ARG(QString, trimmed), Q_ARG(int, limit));
 }
 
-void ClipboardService::wipe() {
-    QString imagePath = QStandardPaths::writableLocation(
-        QStandardPaths::AppDataLocation) + "/clipboard_images/";
-    QDir dir(imagePath);
-    dir.removeRecursively();
+void ClipboardService::onSearchResults(int generation, const QList<ClipboardEntry>& entries, bool done) {
+    if (generation != m_searchGeneration) return;
 
-    QSqlQuery query(m_db);
-    if (!query.exec("DELETE FROM clipboard_history")) {
+    if (m_peerSearch.client >= 0) {
+        m_peer->sendResults(m_peerSearch.client, m_peerSearch.generation, entries, done);
+        if (done) m_peerSearch = {};
         return;
     }
 
-    query.exec("DELETE FROM sqlite_sequence WHERE name='clipboard_history'");
-    query.exec("VACUUM");
+    QList<ClipboardEntry> fresh;
+    for (const ClipboardEntry& entry : entries) {
+        if (m_searchModel->rowOfId(entry.id) < 0) {
+            fresh.append(entry);
+        }
+    }
+    m_searchModel->append(fresh);
 
-    scheduleReload();
+    if (done) {
+        setSearching(false);
+    }
 }
 
-bool ClipboardService::isImage(int index) const {
-    if (index < 0 || index >= m_fullEntries.size()) return false;
-    return m_fullEntries[index].type == "image";
+void ClipboardService::setSearching(bool searching) {
+    if (m_searching == searching) return;
+    m_searching = searching;
+    emit searchingChanged();
 }
 
-QString ClipboardService::getImagePath(int index) const {
-    if (index < 0 || index >= m_fullEntries.size()) return "";
-    if (m_fullEntries[index].type == "image") {
-        return m_fullEntries[index].imagePath;
-    }
-    return "";
+QString ClipboardService::dataDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+}
+
+QString ClipboardService::imageDirectory() {
+    return dataDirectory() + "/clipboard_images/";
 }
 
 void ClipboardService::setMaxEntries(int max) {
@@ -344,6 +628,20 @@ void ClipboardService::setMaxEntries(int max) {
     if (m_maxEntries != max) {
         m_maxEntries = max;
         emit maxEntriesChanged();
-        scheduleReload();
+        if (!m_initialized) return;
+
+        m_model->truncate(m_maxEntries);
+        if (!m_store) return;
+        QMetaObject::invokeMethod(m_store, "setMaxEntries", Q_ARG(int, m_maxEntries));
     }
 }
+
+void ClipboardService::setMaxBytes(qint64 max) {
+    if (max <= 0 || m_maxBytes == max) return;
+
+    m_maxBytes = max;
+    emit maxBytesChanged();
+    if (!m_initialized || !m_store) return;
+
+    QMetaObject::invokeMethod(m_store, "setMaxBytes", Q_ARG(qint64, m_maxBytes));
+}
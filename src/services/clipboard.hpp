@@ -1,35 +1,72 @@
 #pragma once
 #include <QObject>
 #include <QClipboard>
-#include <QSqlDatabase>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <QStringList>
 #include <QImage>
 #include <QMimeData>
-#include <QTimer>
 #include <QQmlEngine>
 #include <qqml.h>
+#include "clipboard_model.hpp"
+#include "clipboard_store.hpp"
+#include "clipboard_image_provider.hpp"
+#include "clipboard_search.hpp"
+#include "clipboard_mime_data.hpp"
+#include "clipboard_dedupe.hpp"
+#include "clipboard_peer.hpp"
 
 class ClipboardService : public QObject {
     Q_OBJECT
     QML_ELEMENT
     QML_SINGLETON
     Q_PROPERTY(QStringList entries READ entries NOTIFY entriesChanged)
+    Q_PROPERTY(ClipboardModel* model READ model CONSTANT)
+    Q_PROPERTY(ClipboardModel* searchModel READ searchModel CONSTANT)
+    Q_PROPERTY(bool searching READ searching NOTIFY searchingChanged)
     Q_PROPERTY(int maxEntries READ maxEntries WRITE setMaxEntries NOTIFY maxEntriesChanged)
+    Q_PROPERTY(int coalesceInterval READ coalesceInterval WRITE setCoalesceInterval NOTIFY coalesceIntervalChanged)
+    Q_PROPERTY(qint64 maxBytes READ maxBytes WRITE setMaxBytes NOTIFY maxBytesChanged)
+    Q_PROPERTY(qint64 storageBytes READ storageBytes NOTIFY storageChanged)
+    Q_PROPERTY(qint64 storedEntries READ storedEntries NOTIFY storageChanged)
+    Q_PROPERTY(qint64 startupSnapshotMs READ startupSnapshotMs NOTIFY startupMetricsChanged)
+    Q_PROPERTY(qint64 startupReadyMs READ startupReadyMs NOTIFY startupMetricsChanged)
+    Q_PROPERTY(bool shared READ shared WRITE setShared NOTIFY sharedChanged)
+    Q_PROPERTY(bool owner READ isOwner NOTIFY ownerChanged)
 
 public:
     static ClipboardService* create(QQmlEngine* engine, QJSEngine*) {
         static ClipboardService* instance = nullptr;
         if (!instance) {
             instance = new ClipboardService();
-            if (engine) {
-                QQmlEngine::setObjectOwnership(instance, QQmlEngine::CppOwnership);
+        }
+        if (engine) {
+            QQmlEngine::setObjectOwnership(instance, QQmlEngine::CppOwnership);
+            if (!engine->imageProvider("clipboard")) {
+                engine->addImageProvider("clipboard", new ClipboardImageProvider(imageDirectory()));
             }
         }
         return instance;
     }
 
+    // Deprecated: bind to `model` instead. Building this list costs O(n), so
+    // entriesChanged only fires when the history is loaded or wiped, not
+    // for individual copies and deletions.
     QStringList entries() const {
-        return m_entries;
+        return m_model->previews();
+    }
+
+    ClipboardModel* model() const {
+        return m_model;
+    }
+
+    ClipboardModel* searchModel() const {
+        return m_searchModel;
+    }
+
+    bool searching() const {
+        return m_searching;
     }
 
     int maxEntries() const {
@@ -38,6 +75,52 @@ public:
 
     void setMaxEntries(int max);
 
+    int coalesceInterval() const {
+        return m_coalesceInterval;
+    }
+
+    void setCoalesceInterval(int ms);
+
+    qint64 maxBytes() const {
+        return m_maxBytes;
+    }
+
+    void setMaxBytes(qint64 max);
+
+    qint64 storageBytes() const {
+        return m_storageBytes;
+    }
+
+    qint64 storedEntries() const {
+        return m_storedEntries;
+    }
+
+    // Time from init() until the snapshot rows were shown, and until the
+    // database had been opened and its first page reconciled. -1 until known.
+    qint64 startupSnapshotMs() const {
+        return m_startupSnapshotMs;
+    }
+
+    qint64 startupReadyMs() const {
+        return m_startupReadyMs;
+    }
+
+    // With `shared` set before init(), processes elect a single owner that
+    // writes the history; the others mirror its shared memory snapshot.
+    bool shared() const {
+        return m_shared;
+    }
+
+    void setShared(bool shared) {
+        if (m_initialized || m_shared == shared) return;
+        m_shared = shared;
+        emit sharedChanged();
+    }
+
+    bool isOwner() const {
+        return !m_peer || m_peer->isOwner();
+    }
+
     Q_INVOKABLE void init();
     Q_INVOKABLE void copyByIndex(int index);
     Q_INVOKABLE void copy(const QString& text);
@@ -45,44 +128,103 @@ public:
     Q_INVOKABLE void wipe();
     Q_INVOKABLE bool isImage(int index) const;
     Q_INVOKABLE QString getImagePath(int index) const;
+    Q_INVOKABLE QString getThumbnail(int index) const;
+    Q_INVOKABLE void search(const QString& query, int limit = 200);
+    Q_INVOKABLE void copySearchResult(int index);
+    // Decodes one of the extra formats of a history row for previewing;
+    // the text arrives through formatReady, empty if it cannot be decoded
+    // or the owner of a shared history is unreachable.
+    Q_INVOKABLE void requestFormat(int index, const QString& mime);
+
+    static QString dataDirectory();
+    static QString imageDirectory();
 
 signals:
     void entriesChanged();
     void entriesRefreshed();
     void maxEntriesChanged();
+    void maxBytesChanged();
+    void coalesceIntervalChanged();
+    void storageChanged();
+    void searchingChanged();
+    void startupMetricsChanged();
+    void sharedChanged();
+    void ownerChanged();
+    void formatReady(int entryId, const QString& mime, const QString& text);
 
 private:
     explicit ClipboardService(QObject* parent = nullptr);
     ~ClipboardService();
 
-    void initDatabase();
-    void loadHistory();
-    void scheduleReload();
-    void storeText(const QString& text);
-    void storeImage(const QImage& image);
+    void startOwner();
+    void startPublishing();
+    void publishSnapshot();
+    bool isSecondary() const;
+    void copyEntry(const ClipboardEntry& entry);
+    bool isNewContent(quint64 digest, const QMimeData* mimeData, bool image,
+                      QList<ClipboardFormat>& formats);
+    void rememberEntry(const ClipboardEntry& entry);
+    void setSearching(bool searching);
+    void finishPeerSearch();
 
 private slots:
     void onClipboardChanged();
-    void performScheduledReload();
+    void ingestClipboard();
+    void onSearchResults(int generation, const QList<ClipboardEntry>& entries, bool done);
+    void onPageLoaded(const QList<ClipboardEntry>& entries, bool reset, bool hasMore);
+    void onContentReady(int id, const QString& content, const QVariantMap& formatFiles);
+    void onEntryStored(const ClipboardEntry& entry);
+    void onEntryRemoved(int id);
+    void onWiped();
+    void onStorageChanged(qint64 entries, qint64 bytes);
+    void onSharedSnapshot();
+    void onOwnerLost();
+    void onPeerRequest(const QByteArray& command, int id);
+    void onPeerFormatRequest(int client, int id, const QString& mime);
+    void onPeerSearch(int client, int generation, const QString& query, int limit);
+    void onFormatReady(int id, const QString& mime, const QString& text);
 
 private:
     QClipboard* m_clipboard;
-    QSqlDatabase m_db;
-    QStringList m_entries;
-    int m_maxEntries = 300;
-    bool m_ignoreNextChange = false;
-    QTimer* m_reloadTimer;
-    bool m_isProcessing = false;
-    QString m_lastClipboardHash;
-    bool m_initialized = false;
+    ClipboardModel* m_model;
+    QThread* m_storeThread = nullptr;
+    ClipboardStore* m_store = nullptr;
+    ClipboardModel* m_searchModel;
+    QThread* m_searchThread = nullptr;
+    ClipboardSearcher* m_searcher = nullptr;
+    int m_searchGeneration = 0;
+    bool m_searching = false;
+    static constexpr int kPageSize = 100;
+    static constexpr int kPublishDelayMs = 30;
+    ClipboardPeer* m_peer = nullptr;
 
-    struct Entry {
+    // Requests forwarded by secondaries, answered on their socket.
+    struct PeerFormat {
+        int client;
         int id;
-        QString type;
-        QString content;
-        QString imagePath;
-        qint64 timestamp;
+        QString mime;
     };
+    struct PeerSearch {
+        int client = -1;
+        int generation = 0;
+    };
+    QList<PeerFormat> m_peerFormats;
+    PeerSearch m_peerSearch;
+    QTimer* m_publishTimer = nullptr;
+    bool m_shared = false;
 
-    QList<Entry> m_fullEntries;
+    int m_maxEntries = 10000;
+    qint64 m_maxBytes = 512ll * 1024 * 1024;
+    qint64 m_storageBytes = 0;
+    qint64 m_storedEntries = 0;
+    ClipboardEntry m_pendingCopy;
+    QTimer* m_coalesceTimer;
+    int m_coalesceInterval = 50;
+    ClipboardDedupeRing m_recent;
+    quint64 m_lastDigest = 0;
+    bool m_hasLastDigest = false;
+    bool m_initialized = false;
+    QElapsedTimer m_startupTimer;
+    qint64 m_startupSnapshotMs = -1;
+    qint64 m_startupReadyMs = -1;
 };
@@ -0,0 +1,63 @@
+#include "clipboard_blob_store.hpp"
+#include "fast_hash.hpp"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace {
+constexpr qint64 kWriteChunk = 256 * 1024;
+}
+
+ClipboardBlobStore::ClipboardBlobStore(const QString& dir)
+    : m_dir(dir)
+{
+}
+
+QString ClipboardBlobStore::pathFor(const QString& key) const {
+    return m_dir + key;
+}
+
+QString ClipboardBlobStore::put(const QByteArray& data) const {
+    const QString key = FastHash::toHex(FastHash::hash(data.constData(), size_t(data.size())));
+    const QString path = pathFor(key);
+    if (QFileInfo::exists(path)) return key;
+
+    QDir().mkpath(m_dir);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return {};
+
+    for (qint64 offset = 0; offset < data.size(); offset += kWriteChunk) {
+        const qint64 len = qMin(kWriteChunk, data.size() - offset);
+        if (file.write(data.constData() + offset, len) != len) {
+            file.cancelWriting();
+            return {};
+        }
+    }
+    return file.commit() ? key : QString();
+}
+
+QByteArray ClipboardBlobStore::read(const QString& key) const {
+    QFile file(pathFor(key));
+    if (!file.open(QIODevice::ReadOnly)) return {};
+    return file.readAll();
+}
+
+void ClipboardBlobStore::remove(const QString& key) const {
+    if (key.isEmpty()) return;
+    QFile::remove(pathFor(key));
+}
+
+int ClipboardBlobStore::removeUnreferenced(const QSet<QString>& referenced) const {
+    if (m_dir.isEmpty()) return 0;
+
+    int removed = 0;
+    QDir dir(m_dir);
+    const QStringList files = dir.entryList(QDir::Files);
+    for (const QString& file : files) {
+        if (!referenced.contains(file) && dir.remove(file)) {
+            ++removed;
+        }
+    }
+    return removed;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+
+// Content-addressed files for the raw bytes of the extra MIME formats an
+// entry was copied with. The key is the FastHash of the bytes, so a payload
+// offered by many entries (the same HTML fragment, a file list) is stored once.
+class ClipboardBlobStore {
+public:
+    ClipboardBlobStore() = default;
+    explicit ClipboardBlobStore(const QString& dir);
+
+    QString directory() const { return m_dir; }
+    QString pathFor(const QString& key) const;
+
+    // Returns the key of `data`, writing the file only if it is not there yet.
+    // An empty key means the write failed.
+    QString put(const QByteArray& data) const;
+    QByteArray read(const QString& key) const;
+    void remove(const QString& key) const;
+
+    // Deletes every blob whose key is not in `referenced`.
+    int removeUnreferenced(const QSet<QString>& referenced) const;
+
+private:
+    QString m_dir;
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <QHash>
+#include <array>
+
+// Remembers the entry ids of the most recently stored payload digests so
+// repeat copies can be resolved without a content_hash lookup. Inserting a
+// digest again moves it to the newest slot; the oldest digests are evicted
+// once the ring is full.
+class ClipboardDedupeRing {
+public:
+    static constexpr int Capacity = 256;
+
+    int idFor(quint64 digest) const {
+        const auto it = m_entries.constFind(digest);
+        return it == m_entries.cend() ? -1 : it->id;
+    }
+
+    void insert(quint64 digest, int id) {
+        auto it = m_entries.find(digest);
+        if (it != m_entries.end()) {
+            m_ring[it->slot].used = false;
+        }
+
+        Slot& slot = m_ring[m_head];
+        if (slot.used) {
+            // Only evict the mapping if it still points at this slot.
+            auto evicted = m_entries.find(slot.digest);
+            if (evicted != m_entries.end() && evicted->slot == m_head) {
+                m_entries.erase(evicted);
+            }
+        }
+        slot.digest = digest;
+        slot.used = true;
+        m_entries.insert(digest, {id, m_head});
+        m_head = (m_head + 1) % Capacity;
+    }
+
+    void removeId(int id) {
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->id == id) {
+                m_ring[it->slot].used = false;
+                m_entries.erase(it);
+                return;
+            }
+        }
+    }
+
+    void clear() {
+        m_entries.clear();
+        m_ring.fill(Slot());
+        m_head = 0;
+    }
+
+private:
+    struct Slot {
+        quint64 digest = 0;
+        bool used = false;
+    };
+
+    struct Entry {
+        int id;
+        int slot;
+    };
+
+    std::array<Slot, Capacity> m_ring{};
+    QHash<quint64, Entry> m_entries;
+    int m_head = 0;
+};
@@ -0,0 +1,113 @@
+#include "clipboard_image_provider.hpp"
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QThread>
+
+namespace {
+bool isValidKey(const QString& key) {
+    if (key.isEmpty() || key.size() > 64) return false;
+    for (QChar c : key) {
+        if (!c.isLetterOrNumber() && c != '_' && c != '-') return false;
+    }
+    return true;
+}
+
+bool writePng(const QImage& image, const QString& path) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    QImageWriter writer(&file, "png");
+    return writer.write(image) && file.commit();
+}
+}
+
+ClipboardImageProvider::ClipboardImageProvider(const QString& imageDir, qsizetype cacheBytes)
+    : m_imageDir(imageDir)
+{
+    m_cache.setMaxCost(cacheBytes);
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+ClipboardImageProvider::~ClipboardImageProvider() {
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QQuickImageResponse* ClipboardImageProvider::requestImageResponse(const QString& id, const QSize& requestedSize) {
+    Q_UNUSED(requestedSize)
+    auto* response = new ClipboardThumbnailResponse(this, id);
+    m_pool.start(response);
+    return response;
+}
+
+QString ClipboardImageProvider::thumbnailPath(const QString& imageDir, const QString& key) {
+    return imageDir + key + ".thumb.png";
+}
+
+QString ClipboardImageProvider::urlForImage(const QString& imagePath) {
+    if (imagePath.isEmpty()) return QString();
+    return "image://clipboard/" + QFileInfo(imagePath).completeBaseName();
+}
+
+QImage ClipboardImageProvider::makeThumbnail(const QImage& image) {
+    if (image.width() <= ThumbnailSize && image.height() <= ThumbnailSize) {
+        return image;
+    }
+    return image.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+
+QImage ClipboardImageProvider::thumbnail(const QString& key) {
+    if (!isValidKey(key)) return QImage();
+
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (QImage* cached = m_cache.object(key)) {
+            return *cached;
+        }
+    }
+
+    const QString thumbPath = thumbnailPath(m_imageDir, key);
+    QImage image(thumbPath);
+
+    if (image.isNull()) {
+        // No persisted thumbnail yet (legacy entry); decode the original once.
+        QImageReader reader(m_imageDir + key + ".png");
+        QSize size = reader.size();
+        if (size.isValid() && (size.width() > ThumbnailSize || size.height() > ThumbnailSize)) {
+            reader.setScaledSize(size.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio));
+        }
+        image = reader.read();
+        if (image.isNull()) return image;
+        writePng(image, thumbPath);
+    }
+
+    QMutexLocker locker(&m_cacheMutex);
+    m_cache.insert(key, new QImage(image), image.sizeInBytes());
+    return image;
+}
+
+ClipboardThumbnailResponse::ClipboardThumbnailResponse(ClipboardImageProvider* provider, const QString& key)
+    : m_provider(provider)
+    , m_key(key)
+{
+    setAutoDelete(false);
+}
+
+void ClipboardThumbnailResponse::run() {
+    if (!m_cancelled.loadRelaxed()) {
+        m_image = m_provider->thumbnail(m_key);
+        if (m_image.isNull()) {
+            m_error = "No clipboard image for " + m_key;
+        }
+    }
+    emit finished();
+}
+
+void ClipboardThumbnailResponse::cancel() {
+    m_cancelled.storeRelaxed(1);
+}
+
+QQuickTextureFactory* ClipboardThumbnailResponse::textureFactory() const {
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
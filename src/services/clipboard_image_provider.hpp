@@ -0,0 +1,52 @@
+#pragma once
+#include <QQuickAsyncImageProvider>
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+
+// Serves image://clipboard/<key> where <key> is the base name of a stored
+// image. Thumbnails are generated once, written as <key>.thumb.png next to
+// the original and kept in a byte-bounded LRU shared by all requests.
+class ClipboardImageProvider : public QQuickAsyncImageProvider {
+public:
+    static constexpr int ThumbnailSize = 256;
+
+    explicit ClipboardImageProvider(const QString& imageDir, qsizetype cacheBytes = 32 * 1024 * 1024);
+    ~ClipboardImageProvider() override;
+
+    QQuickImageResponse* requestImageResponse(const QString& id, const QSize& requestedSize) override;
+
+    static QString thumbnailPath(const QString& imageDir, const QString& key);
+    static QString urlForImage(const QString& imagePath);
+    static QImage makeThumbnail(const QImage& image);
+
+    QImage thumbnail(const QString& key);
+
+private:
+    QString m_imageDir;
+    QThreadPool m_pool;
+    QMutex m_cacheMutex;
+    QCache<QString, QImage> m_cache;
+};
+
+class ClipboardThumbnailResponse : public QQuickImageResponse, public QRunnable {
+    Q_OBJECT
+
+public:
+    ClipboardThumbnailResponse(ClipboardImageProvider* provider, const QString& key);
+
+    void run() override;
+    void cancel() override;
+    QQuickTextureFactory* textureFactory() const override;
+    QString errorString() const override { return m_error; }
+
+private:
+    ClipboardImageProvider* m_provider;
+    QString m_key;
+    QImage m_image;
+    QString m_error;
+    QAtomicInt m_cancelled;
+};
@@ -0,0 +1,102 @@
+#include "clipboard_mime_data.hpp"
+#include <QFile>
+
+namespace {
+constexpr auto kPngFormat = "image/png";
+constexpr auto kQtImageFormat = "application/x-qt-image";
+}
+
+ClipboardMimeData* ClipboardMimeData::forText(const QString& text, const QVariantMap& formatFiles) {
+    auto* data = new ClipboardMimeData();
+    data->setText(text);
+    data->setFormatFiles(formatFiles);
+    return data;
+}
+
+ClipboardMimeData* ClipboardMimeData::forImage(const QString& pngPath, const QVariantMap& formatFiles) {
+    if (!QFile::exists(pngPath)) return nullptr;
+
+    auto* data = new ClipboardMimeData();
+    data->m_pngPath = pngPath;
+    data->setFormatFiles(formatFiles);
+    return data;
+}
+
+void ClipboardMimeData::setFormatFiles(const QVariantMap& formatFiles) {
+    for (auto it = formatFiles.cbegin(); it != formatFiles.cend(); ++it) {
+        // The primary payload always wins over a captured copy of itself.
+        if (it.key() == kPngFormat && !m_pngPath.isEmpty()) continue;
+        if (it.key().startsWith("text/plain") && hasText()) continue;
+        m_formatFiles.insert(it.key(), it.value().toString());
+    }
+}
+
+bool ClipboardMimeData::isOwn(const QMimeData* data) {
+    return qobject_cast<const ClipboardMimeData*>(data) != nullptr
+        || (data && data->hasFormat(MarkerFormat));
+}
+
+QStringList ClipboardMimeData::formats() const {
+    QStringList list = QMimeData::formats();
+    if (!m_pngPath.isEmpty()) {
+        list << kPngFormat << kQtImageFormat;
+    }
+    for (auto it = m_formatFiles.cbegin(); it != m_formatFiles.cend(); ++it) {
+        if (!list.contains(it.key())) list << it.key();
+    }
+    list << MarkerFormat;
+    return list;
+}
+
+bool ClipboardMimeData::hasFormat(const QString& mimeType) const {
+    if (mimeType == MarkerFormat) return true;
+    if (!m_pngPath.isEmpty() && (mimeType == kPngFormat || mimeType == kQtImageFormat)) {
+        return true;
+    }
+    if (m_formatFiles.contains(mimeType)) return true;
+    return QMimeData::hasFormat(mimeType);
+}
+
+QVariant ClipboardMimeData::retrieveData(const QString& mimeType, QMetaType type) const {
+    if (mimeType == MarkerFormat) {
+        return QByteArray("1");
+    }
+
+    auto file = m_formatFiles.constFind(mimeType);
+    if (file != m_formatFiles.cend()) {
+        auto cached = m_formatData.constFind(mimeType);
+        if (cached != m_formatData.cend()) return *cached;
+
+        QFile blob(*file);
+        QByteArray bytes;
+        if (blob.open(QIODevice::ReadOnly)) {
+            bytes = blob.readAll();
+        }
+        m_formatData.insert(mimeType, bytes);
+        return bytes;
+    }
+
+    if (m_pngPath.isEmpty()) {
+        return QMimeData::retrieveData(mimeType, type);
+    }
+
+    if (m_png.isEmpty() && (mimeType == kPngFormat || mimeType == kQtImageFormat)) {
+        QFile file(m_pngPath);
+        if (file.open(QIODevice::ReadOnly)) {
+            m_png = file.readAll();
+        }
+    }
+
+    if (mimeType == kPngFormat) {
+        return m_png;
+    }
+
+    if (mimeType == kQtImageFormat) {
+        if (m_image.isNull() && !m_png.isEmpty()) {
+            m_image.loadFromData(m_png, "PNG");
+        }
+        return m_image;
+    }
+
+    return QMimeData::retrieveData(mimeType, type);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <QMimeData>
+#include <QImage>
+#include <QHash>
+#include <QVariantMap>
+
+// Clipboard payload published by ClipboardService itself. Stored PNGs are
+// served as-is for image/png; other image formats are converted from a
+// lazily decoded QImage only when a client asks for them. Extra formats
+// captured with the entry are backed by blob files and read on request. The
+// marker format lets the service recognise its own data when dataChanged fires.
+class ClipboardMimeData : public QMimeData {
+    Q_OBJECT
+
+public:
+    static constexpr auto MarkerFormat = "application/x-noon-clipboard";
+
+    // `formatFiles` maps MIME types to the files holding their bytes.
+    static ClipboardMimeData* forText(const QString& text, const QVariantMap& formatFiles = {});
+    static ClipboardMimeData* forImage(const QString& pngPath, const QVariantMap& formatFiles = {});
+
+    static bool isOwn(const QMimeData* data);
+
+    QStringList formats() const override;
+    bool hasFormat(const QString& mimeType) const override;
+
+protected:
+    QVariant retrieveData(const QString& mimeType, QMetaType type) const override;
+
+private:
+    ClipboardMimeData() = default;
+
+    void setFormatFiles(const QVariantMap& formatFiles);
+
+    QString m_pngPath;
+    mutable QByteArray m_png;
+    mutable QImage m_image;
+    QHash<QString, QString> m_formatFiles;
+    mutable QHash<QString, QByteArray> m_formatData;
+};
@@ -0,0 +1,290 @@
+#include "clipboard_model.hpp"
+#include "clipboard_image_provider.hpp"
+#include <QSet>
+
+ClipboardModel::ClipboardModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int ClipboardModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return m_entries.size();
+}
+
+QVariant ClipboardModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_entries.size()) {
+        return {};
+    }
+
+    const ClipboardEntry& entry = m_entries[index.row()];
+    switch (role) {
+    case IdRole:
+        return entry.id;
+    case Qt::DisplayRole:
+    case PreviewRole:
+        return entry.preview;
+    case TypeRole:
+        return entry.type;
+    case ImagePathRole:
+        return entry.imagePath;
+    case ThumbnailRole:
+        return ClipboardImageProvider::urlForImage(entry.imagePath);
+    case TimestampRole:
+        return entry.timestamp;
+    case FormatsRole:
+        return entry.formats;
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> ClipboardModel::roleNames() const {
+    return {
+        {IdRole, "entryId"},
+        {PreviewRole, "preview"},
+        {TypeRole, "type"},
+        {ImagePathRole, "imagePath"},
+        {ThumbnailRole, "thumbnail"},
+        {TimestampRole, "timestamp"},
+        {FormatsRole, "formats"}
+    };
+}
+
+bool ClipboardModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && m_hasMore && !m_fetching;
+}
+
+void ClipboardModel::fetchMore(const QModelIndex& parent) {
+    if (!canFetchMore(parent)) return;
+
+    m_fetching = true;
+    if (m_entries.isEmpty()) {
+        emit moreRequested(0, -1);
+    } else {
+        const ClipboardEntry& last = m_entries.last();
+        emit moreRequested(last.timestamp, last.id);
+    }
+}
+
+void ClipboardModel::setHasMore(bool hasMore) {
+    m_fetching = false;
+    if (m_hasMore == hasMore) return;
+    m_hasMore = hasMore;
+    emit hasMoreChanged();
+}
+
+const ClipboardEntry* ClipboardModel::entryAt(int row) const {
+    if (row < 0 || row >= m_entries.size()) return nullptr;
+    return &m_entries[row];
+}
+
+int ClipboardModel::rowOfId(int id) const {
+    const auto it = m_positions.constFind(id);
+    return it == m_positions.cend() ? -1 : it.value() - m_base;
+}
+
+void ClipboardModel::reindex() {
+    m_base = 0;
+    m_positions.clear();
+    m_positions.reserve(m_entries.size());
+    for (int row = 0; row < m_entries.size(); ++row) {
+        m_positions.insert(m_entries[row].id, row);
+    }
+}
+
+QStringList ClipboardModel::previews() const {
+    QStringList list;
+    list.reserve(m_entries.size());
+    for (const ClipboardEntry& entry : m_entries) {
+        list.append(entry.preview);
+    }
+    return list;
+}
+
+void ClipboardModel::setEntries(const QList<ClipboardEntry>& entries) {
+    const int oldCount = m_entries.size();
+    beginResetModel();
+    m_entries = entries;
+    reindex();
+    endResetModel();
+    if (oldCount != m_entries.size()) emit countChanged();
+}
+
+void ClipboardModel::reconcile(const QList<ClipboardEntry>& entries) {
+    const int oldCount = m_entries.size();
+
+    // Turn the current rows into `entries` with row-level removes, moves and
+    // inserts. Usually the rows already match (warm start) or differ by one
+    // copy at the top (shared snapshot), so delegates survive.
+    QSet<int> wanted;
+    wanted.reserve(entries.size());
+    for (const ClipboardEntry& entry : entries) {
+        wanted.insert(entry.id);
+    }
+    for (int row = m_entries.size() - 1; row >= 0; --row) {
+        if (!wanted.contains(m_entries[row].id)) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_entries.removeAt(row);
+            endRemoveRows();
+        }
+    }
+
+    for (int i = 0; i < entries.size(); ++i) {
+        const ClipboardEntry& next = entries[i];
+        if (i < m_entries.size() && m_entries[i].id == next.id) {
+            updateRow(i, next);
+            continue;
+        }
+
+        int from = -1;
+        for (int j = i + 1; j < m_entries.size(); ++j) {
+            if (m_entries[j].id == next.id) {
+                from = j;
+                break;
+            }
+        }
+
+        if (from >= 0) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+            m_entries.move(from, i);
+            endMoveRows();
+            updateRow(i, next);
+        } else {
+            beginInsertRows(QModelIndex(), i, i);
+            m_entries.insert(i, next);
+            endInsertRows();
+        }
+    }
+    reindex();
+
+    if (oldCount != m_entries.size()) emit countChanged();
+}
+
+void ClipboardModel::updateRow(int row, const ClipboardEntry& next) {
+    ClipboardEntry& current = m_entries[row];
+    if (current.preview == next.preview && current.imagePath == next.imagePath
+        && current.timestamp == next.timestamp && current.type == next.type
+        && current.formats == next.formats) {
+        current.hash = next.hash;
+        return;
+    }
+    current = next;
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed);
+}
+
+void ClipboardModel::prepend(const ClipboardEntry& entry) {
+    beginInsertRows(QModelIndex(), 0, 0);
+    m_entries.prepend(entry);
+    m_positions.insert(entry.id, --m_base);
+    endInsertRows();
+    emit countChanged();
+}
+
+void ClipboardModel::append(const QList<ClipboardEntry>& entries) {
+    // A page can overlap rows already shown, e.g. when an entry was copied
+    // between two page loads and shifted the offsets. Keep ids unique.
+    QList<ClipboardEntry> fresh;
+    fresh.reserve(entries.size());
+    QSet<int> seen;
+    for (const ClipboardEntry& entry : entries) {
+        if (m_positions.contains(entry.id) || seen.contains(entry.id)) continue;
+        seen.insert(entry.id);
+        fresh.append(entry);
+    }
+    if (fresh.isEmpty()) return;
+
+    const int first = m_entries.size();
+    beginInsertRows(QModelIndex(), first, first + fresh.size() - 1);
+    m_entries.append(fresh);
+    for (int row = first; row < m_entries.size(); ++row) {
+        m_positions.insert(m_entries[row].id, m_base + row);
+    }
+    endInsertRows();
+    emit countChanged();
+}
+
+void ClipboardModel::moveToTop(int row, const ClipboardEntry& updated) {
+    if (row < 0 || row >= m_entries.size()) return;
+
+    if (row > 0) {
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), 0);
+        m_entries.move(row, 0);
+        // Only the rows above the old position shift; re-copies are nearly
+        // always of recent entries, so this is short.
+        for (int i = 1; i <= row; ++i) {
+            m_positions[m_entries[i].id] = m_base + i;
+        }
+        m_positions[m_entries[0].id] = m_base;
+        endMoveRows();
+    }
+
+    QList<int> roles;
+    ClipboardEntry& top = m_entries[0];
+    if (top.timestamp != updated.timestamp) {
+        top.timestamp = updated.timestamp;
+        roles.append(TimestampRole);
+    }
+    if (top.formats != updated.formats) {
+        top.formats = updated.formats;
+        roles.append(FormatsRole);
+    }
+    if (!roles.isEmpty()) {
+        const QModelIndex first = index(0);
+        emit dataChanged(first, first, roles);
+    }
+}
+
+void ClipboardModel::removeAt(int row) {
+    if (row < 0 || row >= m_entries.size()) return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_positions.remove(m_entries[row].id);
+    m_entries.removeAt(row);
+    // Renumber whichever side of the gap is shorter.
+    if (row < m_entries.size() - row) {
+        for (int i = 0; i < row; ++i) {
+            m_positions[m_entries[i].id] = m_base + 1 + i;
+        }
+        ++m_base;
+    } else {
+        for (int i = row; i < m_entries.size(); ++i) {
+            m_positions[m_entries[i].id] = m_base + i;
+        }
+    }
+    endRemoveRows();
+    emit countChanged();
+}
+
+void ClipboardModel::truncate(int maxRows) {
+    if (maxRows < 0 || m_entries.size() <= maxRows) return;
+
+    beginRemoveRows(QModelIndex(), maxRows, m_entries.size() - 1);
+    for (int row = maxRows; row < m_entries.size(); ++row) {
+        m_positions.remove(m_entries[row].id);
+    }
+    m_entries.resize(maxRows);
+    endRemoveRows();
+    emit countChanged();
+}
+
+void ClipboardModel::clear() {
+    setHasMore(false);
+    if (m_entries.isEmpty()) return;
+
+    beginResetModel();
+    m_entries.clear();
+    reindex();
+    endResetModel();
+    emit countChanged();
+}
+
+QString ClipboardModel::makePreview(const QString& content) {
+    QString displayText = content.left(101);
+    displayText.replace('\n', ' ').replace('\t', ' ');
+    if (displayText.length() > 100) {
+        displayText = displayText.left(100) + "...";
+    }
+    return displayText;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <qqml.h>
+
+struct ClipboardEntry {
+    int id = -1;
+    QString type;
+    QString preview;
+    QString imagePath;
+    QString hash;
+    qint64 timestamp = 0;
+    QStringList formats;
+};
+Q_DECLARE_METATYPE(ClipboardEntry)
+
+// Row-level view of the clipboard history. Every mutation touches only the
+// affected rows so QML delegates are reused instead of being rebuilt.
+class ClipboardModel : public QAbstractListModel {
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("ClipboardModel is provided by ClipboardService")
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(bool hasMore READ hasMore NOTIFY hasMoreChanged)
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,
+        PreviewRole,
+        TypeRole,
+        ImagePathRole,
+        ThumbnailRole,
+        TimestampRole,
+        FormatsRole
+    };
+    Q_ENUM(Roles)
+
+    explicit ClipboardModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    int count() const { return m_entries.size(); }
+    bool hasMore() const { return m_hasMore; }
+    void setHasMore(bool hasMore);
+    const ClipboardEntry* entryAt(int row) const;
+    int rowOfId(int id) const;
+    QStringList previews() const;
+
+    void setEntries(const QList<ClipboardEntry>& entries);
+    void reconcile(const QList<ClipboardEntry>& entries);
+    void prepend(const ClipboardEntry& entry);
+    void append(const QList<ClipboardEntry>& entries);
+    void moveToTop(int row, const ClipboardEntry& updated);
+    void removeAt(int row);
+    void truncate(int maxRows);
+    void clear();
+
+    static QString makePreview(const QString& content);
+
+signals:
+    void countChanged();
+    void hasMoreChanged();
+    void moreRequested(qint64 beforeTimestamp, int beforeId);
+
+private:
+    void updateRow(int row, const ClipboardEntry& next);
+    void reindex();
+
+    QList<ClipboardEntry> m_entries;
+    // id -> row + m_base. Prepending lowers m_base instead of renumbering
+    // every row, so lookups and top-of-list changes stay O(1).
+    QHash<int, int> m_positions;
+    int m_base = 0;
+    bool m_hasMore = false;
+    bool m_fetching = false;
+};
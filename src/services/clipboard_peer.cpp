@@ -0,0 +1,267 @@
+#include "clipboard_peer.hpp"
+#include "clipboard_snapshot.hpp"
+#include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+constexpr char kMagic[4] = {'N', 'C', 'S', 'M'};
+constexpr quint32 kLayoutVersion = 1;
+constexpr qsizetype kHeaderSize = 32;
+constexpr qsizetype kSegmentSize = 1024 * 1024;
+constexpr int kRetryDelayMs = 500;
+
+QString runtimePath(const QString& name) {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation)).filePath(name);
+}
+}
+
+ClipboardPeer::ClipboardPeer(QObject* parent)
+    : QObject(parent)
+    , m_lock(runtimePath("noon-clipboard.lock"))
+    , m_memory(runtimePath("noon-clipboard-snapshot"))
+    , m_retryTimer(new QTimer(this))
+{
+    m_lock.setStaleLockTime(0);
+
+    // A vanished owner is only reported after a short pause so the
+    // replacement election does not spin while the old socket goes away.
+    m_retryTimer->setSingleShot(true);
+    m_retryTimer->setInterval(kRetryDelayMs);
+    connect(m_retryTimer, &QTimer::timeout, this, &ClipboardPeer::ownerLost);
+}
+
+ClipboardPeer::~ClipboardPeer() {
+    if (m_server) {
+        m_server->close();
+    }
+    if (m_owner) {
+        m_lock.unlock();
+    }
+}
+
+bool ClipboardPeer::elect() {
+    if (m_owner) return true;
+
+    if (m_lock.tryLock(0)) {
+        becomeOwner();
+        return true;
+    }
+
+    connectToOwner();
+    return false;
+}
+
+void ClipboardPeer::becomeOwner() {
+    m_owner = true;
+    m_retryTimer->stop();
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->deleteLater();
+        m_socket = nullptr;
+    }
+
+    // A segment left behind by a crashed owner is reused.
+    if (m_memory.isAttached()) {
+        m_memory.detach();
+    }
+    if (!m_memory.create(kSegmentSize)
+        && !(m_memory.error() == QSharedMemory::AlreadyExists && m_memory.attach())) {
+        qWarning() << "Clipboard snapshot segment unavailable:" << m_memory.errorString();
+    }
+    if (m_memory.isAttached() && m_memory.lock()) {
+        const auto* base = static_cast<const uchar*>(m_memory.constData());
+        if (std::memcmp(base, kMagic, sizeof(kMagic)) == 0) {
+            m_generation = qFromLittleEndian<quint32>(base + 8);
+        }
+        m_memory.unlock();
+    }
+
+    const QString path = runtimePath("noon-clipboard");
+    QLocalServer::removeServer(path);
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &ClipboardPeer::onNewConnection);
+    if (!m_server->listen(path)) {
+        qWarning() << "Clipboard owner socket unavailable:" << m_server->errorString();
+    }
+}
+
+void ClipboardPeer::connectToOwner() {
+    if (!m_socket) {
+        m_socket = new QLocalSocket(this);
+        connect(m_socket, &QLocalSocket::connected, this, &ClipboardPeer::snapshotChanged);
+        connect(m_socket, &QLocalSocket::readyRead, this, &ClipboardPeer::onOwnerReadyRead);
+        connect(m_socket, &QLocalSocket::disconnected, m_retryTimer, qOverload<>(&QTimer::start));
+        connect(m_socket, &QLocalSocket::errorOccurred, m_retryTimer, qOverload<>(&QTimer::start));
+    }
+    if (m_socket->state() == QLocalSocket::UnconnectedState) {
+        m_socket->connectToServer(runtimePath("noon-clipboard"));
+    }
+}
+
+void ClipboardPeer::publish(const QList<ClipboardEntry>& entries, qint64 storedEntries,
+                            qint64 storageBytes) {
+    if (!m_owner || !m_memory.isAttached()) return;
+
+    QList<ClipboardEntry> fitting = entries;
+    QByteArray payload = ClipboardSnapshot::serialize(fitting);
+    while (payload.size() > m_memory.size() - kHeaderSize && !fitting.isEmpty()) {
+        fitting.resize(fitting.size() / 2);
+        payload = ClipboardSnapshot::serialize(fitting);
+    }
+
+    if (!m_memory.lock()) return;
+    auto* base = static_cast<uchar*>(m_memory.data());
+    std::memcpy(base + kHeaderSize, payload.constData(), size_t(payload.size()));
+    std::memcpy(base, kMagic, sizeof(kMagic));
+    qToLittleEndian<quint32>(kLayoutVersion, base + 4);
+    qToLittleEndian<quint32>(++m_generation, base + 8);
+    qToLittleEndian<quint32>(quint32(payload.size()), base + 12);
+    qToLittleEndian<qint64>(storedEntries, base + 16);
+    qToLittleEndian<qint64>(storageBytes, base + 24);
+    m_memory.unlock();
+
+    const QByteArray line = "snapshot " + QByteArray::number(m_generation) + '\n';
+    for (QLocalSocket* client : std::as_const(m_clients)) {
+        client->write(line);
+    }
+}
+
+bool ClipboardPeer::readSnapshot(QList<ClipboardEntry>& entries, qint64& storedEntries,
+                                 qint64& storageBytes) {
+    if (!m_memory.isAttached() && !m_memory.attach(QSharedMemory::ReadOnly)) return false;
+    if (!m_memory.lock()) return false;
+
+    // Parsed straight out of the mapping; nothing is copied before decoding.
+    const auto* base = static_cast<const uchar*>(m_memory.constData());
+    bool ok = std::memcmp(base, kMagic, sizeof(kMagic)) == 0
+        && qFromLittleEndian<quint32>(base + 4) == kLayoutVersion;
+    if (ok) {
+        const quint32 payloadSize = qFromLittleEndian<quint32>(base + 12);
+        ok = payloadSize <= m_memory.size() - kHeaderSize
+            && ClipboardSnapshot::parse(base + kHeaderSize, payloadSize, entries);
+        if (ok) {
+            storedEntries = qFromLittleEndian<qint64>(base + 16);
+            storageBytes = qFromLittleEndian<qint64>(base + 24);
+        }
+    }
+    m_memory.unlock();
+    return ok;
+}
+
+void ClipboardPeer::sendRequest(const QByteArray& command, int id) {
+    QByteArray line = command;
+    if (id >= 0) {
+        line += ' ' + QByteArray::number(id);
+    }
+    sendLine(line);
+}
+
+// Free-form fields (MIME types, queries, text, result rows) are base64 so a
+// request stays one space separated line.
+bool ClipboardPeer::requestFormat(int id, const QString& mime) {
+    return sendLine("format " + QByteArray::number(id) + ' ' + mime.toUtf8().toBase64());
+}
+
+bool ClipboardPeer::requestSearch(int generation, const QString& query, int limit) {
+    return sendLine("search " + QByteArray::number(generation) + ' ' + QByteArray::number(limit)
+                    + ' ' + query.toUtf8().toBase64());
+}
+
+void ClipboardPeer::sendFormat(int client, int id, const QString& mime, const QString& text) {
+    QLocalSocket* socket = m_clients.value(client);
+    if (!socket) return;
+    socket->write("format " + QByteArray::number(id) + ' ' + mime.toUtf8().toBase64() + ' '
+                  + text.toUtf8().toBase64() + '\n');
+}
+
+void ClipboardPeer::sendResults(int client, int generation, const QList<ClipboardEntry>& entries,
+                                bool done) {
+    QLocalSocket* socket = m_clients.value(client);
+    if (!socket) return;
+    socket->write("results " + QByteArray::number(generation) + ' ' + (done ? "1 " : "0 ")
+                  + ClipboardSnapshot::serialize(entries).toBase64() + '\n');
+}
+
+bool ClipboardPeer::sendLine(const QByteArray& line) {
+    if (m_owner || !m_socket || m_socket->state() != QLocalSocket::ConnectedState) return false;
+    m_socket->write(line + '\n');
+    return true;
+}
+
+void ClipboardPeer::onNewConnection() {
+    while (QLocalSocket* client = m_server->nextPendingConnection()) {
+        const int clientId = m_nextClient++;
+        m_clients.insert(clientId, client);
+        connect(client, &QLocalSocket::readyRead, this, &ClipboardPeer::onClientReadyRead);
+        connect(client, &QLocalSocket::disconnected, this, [this, client, clientId] {
+            m_clients.remove(clientId);
+            client->deleteLater();
+        });
+        if (m_generation > 0) {
+            client->write("snapshot " + QByteArray::number(m_generation) + '\n');
+        }
+    }
+}
+
+void ClipboardPeer::onClientReadyRead() {
+    auto* client = qobject_cast<QLocalSocket*>(sender());
+    if (!client) return;
+
+    while (client->canReadLine()) {
+        const QList<QByteArray> parts = client->readLine().trimmed().split(' ');
+        const QByteArray& command = parts.first();
+        if (command == "wipe") {
+            emit requestReceived(command, -1);
+        } else if ((command == "copy" || command == "delete") && parts.size() == 2) {
+            bool ok = false;
+            const int id = parts[1].toInt(&ok);
+            if (ok) emit requestReceived(command, id);
+        } else if (command == "format" && parts.size() >= 3) {
+            bool ok = false;
+            const int id = parts[1].toInt(&ok);
+            if (ok) {
+                emit formatRequested(m_clients.key(client), id,
+                                     QString::fromUtf8(QByteArray::fromBase64(parts[2])));
+            }
+        } else if (command == "search" && parts.size() >= 3) {
+            bool generationOk = false;
+            bool limitOk = false;
+            const int generation = parts[1].toInt(&generationOk);
+            const int limit = parts[2].toInt(&limitOk);
+            // An empty trailing field is lost to trimmed(), hence value().
+            if (generationOk && limitOk) {
+                emit searchRequested(m_clients.key(client), generation,
+                                     QString::fromUtf8(QByteArray::fromBase64(parts.value(3))), limit);
+            }
+        }
+    }
+}
+
+void ClipboardPeer::onOwnerReadyRead() {
+    bool changed = false;
+    while (m_socket->canReadLine()) {
+        const QList<QByteArray> parts = m_socket->readLine().trimmed().split(' ');
+        const QByteArray& command = parts.first();
+        if (command == "snapshot") {
+            changed = true;
+        } else if (command == "format" && parts.size() >= 3) {
+            emit formatReceived(parts[1].toInt(), QString::fromUtf8(QByteArray::fromBase64(parts[2])),
+                                QString::fromUtf8(QByteArray::fromBase64(parts.value(3))));
+        } else if (command == "results" && parts.size() >= 3) {
+            const QByteArray payload = QByteArray::fromBase64(parts.value(3));
+            QList<ClipboardEntry> entries;
+            if (!payload.isEmpty()) {
+                ClipboardSnapshot::parse(reinterpret_cast<const uchar*>(payload.constData()),
+                                         payload.size(), entries);
+            }
+            emit resultsReceived(parts[1].toInt(), entries, parts[2] == "1");
+        }
+    }
+    if (changed) {
+        emit snapshotChanged();
+    }
+}
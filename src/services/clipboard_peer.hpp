@@ -0,0 +1,73 @@
+#pragma once
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QLockFile>
+#include <QSharedMemory>
+#include <QTimer>
+#include <QList>
+#include <QHash>
+#include "clipboard_model.hpp"
+
+// Lets several shell processes share one clipboard history. Whichever process
+// takes the lock file first becomes the owner: it runs the store, publishes
+// the newest rows into a read-only shared memory segment and announces every
+// new generation over a local socket. The other processes map the segment and
+// forward copy/delete/wipe requests, searches and format lookups to the owner
+// instead of opening the database themselves; the owner answers the latter
+// two on the requesting client's socket.
+//
+// Segment layout (little endian): magic "NCSM", u32 layout version,
+// u32 generation, u32 payload size, i64 stored entries, i64 stored bytes,
+// followed by a ClipboardSnapshot payload.
+class ClipboardPeer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ClipboardPeer(QObject* parent = nullptr);
+    ~ClipboardPeer();
+
+    // Becomes the owner if no live process holds the history, otherwise
+    // connects to the owner. Safe to call again after ownerLost().
+    bool elect();
+    bool isOwner() const { return m_owner; }
+
+    void publish(const QList<ClipboardEntry>& entries, qint64 storedEntries, qint64 storageBytes);
+    bool readSnapshot(QList<ClipboardEntry>& entries, qint64& storedEntries, qint64& storageBytes);
+    void sendRequest(const QByteArray& command, int id = -1);
+    // Secondary side; false when the owner is not reachable.
+    bool requestFormat(int id, const QString& mime);
+    bool requestSearch(int generation, const QString& query, int limit);
+    // Owner side; `client` comes from formatRequested/searchRequested.
+    void sendFormat(int client, int id, const QString& mime, const QString& text);
+    void sendResults(int client, int generation, const QList<ClipboardEntry>& entries, bool done);
+
+signals:
+    void snapshotChanged();
+    void requestReceived(const QByteArray& command, int id);
+    void formatRequested(int client, int id, const QString& mime);
+    void searchRequested(int client, int generation, const QString& query, int limit);
+    void formatReceived(int id, const QString& mime, const QString& text);
+    void resultsReceived(int generation, const QList<ClipboardEntry>& entries, bool done);
+    void ownerLost();
+
+private slots:
+    void onNewConnection();
+    void onClientReadyRead();
+    void onOwnerReadyRead();
+
+private:
+    void becomeOwner();
+    void connectToOwner();
+    bool sendLine(const QByteArray& line);
+
+    QLockFile m_lock;
+    QLocalServer* m_server = nullptr;
+    QLocalSocket* m_socket = nullptr;
+    QHash<int, QLocalSocket*> m_clients;
+    int m_nextClient = 0;
+    QSharedMemory m_memory;
+    QTimer* m_retryTimer;
+    quint32 m_generation = 0;
+    bool m_owner = false;
+};
@@ -0,0 +1,218 @@
+#include "clipboard_retention.hpp"
+#include "clipboard_image_provider.hpp"
+#include "clipboard_model.hpp"
+#include <QSqlQuery>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+ClipboardRetention::ClipboardRetention(QSqlDatabase& db, const QString& imageDir,
+                                       const ClipboardBlobStore& blobs)
+    : m_db(db)
+    , m_imageDir(imageDir)
+    , m_blobs(blobs)
+{
+}
+
+ClipboardRetention::Usage ClipboardRetention::usage() {
+    if (m_usageKnown) return m_usage;
+
+    QSqlQuery query(m_db);
+    if (query.exec("SELECT COUNT(*), COALESCE(SUM(size_bytes), 0) FROM clipboard_history") && query.next()) {
+        m_usage.entries = query.value(0).toLongLong();
+        m_usage.bytes = query.value(1).toLongLong();
+        m_usageKnown = true;
+    }
+    return m_usage;
+}
+
+void ClipboardRetention::adjustUsage(qint64 entries, qint64 bytes) {
+    m_usage.entries += entries;
+    m_usage.bytes += bytes;
+}
+
+bool ClipboardRetention::backfillSizes(int limit) {
+    QSqlQuery text(m_db);
+    text.prepare(R"(
+        UPDATE clipboard_history
+        SET size_bytes = COALESCE(length(content_blob), length(CAST(content AS BLOB)), 0)
+        WHERE id IN (SELECT id FROM clipboard_history WHERE size_bytes IS NULL AND type = 'text' LIMIT :limit)
+    )");
+    text.bindValue(":limit", limit);
+    text.exec();
+    int measured = qMax(0, text.numRowsAffected());
+
+    QSqlQuery images(m_db);
+    images.prepare("SELECT id, image_path FROM clipboard_history WHERE size_bytes IS NULL AND type = 'image' LIMIT :limit");
+    images.bindValue(":limit", limit);
+    if (images.exec()) {
+        QSqlQuery update(m_db);
+        update.prepare("UPDATE clipboard_history SET size_bytes = :size WHERE id = :id");
+        while (images.next()) {
+            const QString path = images.value(1).toString();
+            const QString thumb = ClipboardImageProvider::thumbnailPath(
+                m_imageDir, QFileInfo(path).completeBaseName());
+            update.bindValue(":size", QFileInfo(path).size() + QFileInfo(thumb).size());
+            update.bindValue(":id", images.value(0));
+            update.exec();
+            ++measured;
+        }
+    }
+
+    // Newly measured rows are not in the running totals yet.
+    if (measured > 0) invalidateUsage();
+    return measured >= limit;
+}
+
+bool ClipboardRetention::backfillPreviews(int limit) {
+    QSqlQuery select(m_db);
+    select.setForwardOnly(true);
+    select.prepare(R"(
+        SELECT id, substr(content, 1, 101) FROM clipboard_history
+        WHERE preview IS NULL AND type = 'text'
+        LIMIT :limit
+    )");
+    select.bindValue(":limit", limit);
+    if (!select.exec()) return false;
+
+    QList<QPair<int, QString>> previews;
+    while (select.next()) {
+        previews.append({select.value(0).toInt(), ClipboardModel::makePreview(select.value(1).toString())});
+    }
+    select.finish();
+
+    QSqlQuery update(m_db);
+    update.prepare("UPDATE clipboard_history SET preview = :preview WHERE id = :id");
+    for (const auto& [id, preview] : std::as_const(previews)) {
+        update.bindValue(":preview", preview);
+        update.bindValue(":id", id);
+        update.exec();
+    }
+
+    return previews.size() >= limit;
+}
+
+ClipboardRetention::Pruned ClipboardRetention::prune(int maxEntries, qint64 maxBytes, int limit,
+                                                     bool& overQuota) {
+    Pruned pruned;
+    const Usage current = usage();
+    overQuota = current.entries > maxEntries || current.bytes > maxBytes;
+    if (!overQuota) return pruned;
+
+    QSqlQuery oldest(m_db);
+    oldest.setForwardOnly(true);
+    oldest.prepare(R"(
+        SELECT id, type, image_path, COALESCE(size_bytes, 0) FROM clipboard_history
+        ORDER BY timestamp ASC, id ASC
+        LIMIT :limit
+    )");
+    oldest.bindValue(":limit", limit);
+    if (!oldest.exec()) return pruned;
+
+    struct Candidate {
+        int id;
+        QString image;
+        qint64 bytes;
+    };
+    QList<Candidate> candidates;
+    qint64 entries = current.entries;
+    qint64 bytes = current.bytes;
+    while (oldest.next() && (entries > maxEntries || bytes > maxBytes)) {
+        const bool image = oldest.value(1).toString() == "image";
+        candidates.append({oldest.value(0).toInt(), image ? oldest.value(2).toString() : QString(),
+                           oldest.value(3).toLongLong()});
+        entries -= 1;
+        bytes -= candidates.last().bytes;
+    }
+    oldest.finish();
+
+    QSqlQuery remove(m_db);
+    remove.prepare("DELETE FROM clipboard_history WHERE id = :id");
+    for (const Candidate& candidate : std::as_const(candidates)) {
+        const QStringList blobs = blobsOf(candidate.id);
+        remove.bindValue(":id", candidate.id);
+        if (!remove.exec()) break;
+
+        pruned.ids.append(candidate.id);
+        pruned.blobs += blobs;
+        if (!candidate.image.isEmpty()) pruned.images.append(candidate.image);
+        adjustUsage(-1, -candidate.bytes);
+    }
+
+    overQuota = m_usage.entries > maxEntries || m_usage.bytes > maxBytes;
+    return pruned;
+}
+
+void ClipboardRetention::removeFiles(const Pruned& pruned) const {
+    for (const QString& path : pruned.images) {
+        removeImageFiles(path);
+    }
+    releaseBlobs(pruned.blobs);
+}
+
+int ClipboardRetention::sweepOrphans() {
+    QSet<QString> referenced;
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT image_path FROM clipboard_history WHERE type = 'image'")) {
+        return 0;
+    }
+    while (query.next()) {
+        referenced.insert(QFileInfo(query.value(0).toString()).completeBaseName());
+    }
+
+    int removed = 0;
+    QDir dir(m_imageDir);
+    const QStringList files = dir.entryList({"*.png"}, QDir::Files);
+    for (const QString& file : files) {
+        QString key = file;
+        key.chop(file.endsWith(".thumb.png") ? 10 : 4);
+        if (!referenced.contains(key) && dir.remove(file)) {
+            ++removed;
+        }
+    }
+
+    QSet<QString> blobs;
+    if (query.exec("SELECT DISTINCT blob_hash FROM clipboard_formats")) {
+        while (query.next()) {
+            blobs.insert(query.value(0).toString());
+        }
+        removed += m_blobs.removeUnreferenced(blobs);
+    }
+    return removed;
+}
+
+void ClipboardRetention::removeImageFiles(const QString& imagePath) const {
+    if (imagePath.isEmpty()) return;
+    QFile::remove(imagePath);
+    QFile::remove(ClipboardImageProvider::thumbnailPath(
+        m_imageDir, QFileInfo(imagePath).completeBaseName()));
+}
+
+QStringList ClipboardRetention::blobsOf(int id) const {
+    QStringList keys;
+    QSqlQuery query(m_db);
+    query.prepare("SELECT blob_hash FROM clipboard_formats WHERE entry_id = :id");
+    query.bindValue(":id", id);
+    if (query.exec()) {
+        while (query.next()) {
+            keys.append(query.value(0).toString());
+        }
+    }
+    return keys;
+}
+
+void ClipboardRetention::releaseBlobs(const QStringList& keys) const {
+    if (keys.isEmpty()) return;
+
+    QSqlQuery query(m_db);
+    query.prepare("SELECT 1 FROM clipboard_formats WHERE blob_hash = :hash LIMIT 1");
+    const QSet<QString> unique(keys.cbegin(), keys.cend());
+    for (const QString& key : unique) {
+        query.bindValue(":hash", key);
+        if (query.exec() && !query.next()) {
+            m_blobs.remove(key);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <QSqlDatabase>
+#include <QString>
+#include <QList>
+#include "clipboard_blob_store.hpp"
+
+// Enforces the clipboard quotas in small steps so a single pass never holds
+// the writer for long. Runs on the store thread against its connection.
+class ClipboardRetention {
+public:
+    struct Usage {
+        qint64 entries = 0;
+        qint64 bytes = 0;
+    };
+
+    // Rows deleted by prune(). Their files are left alone until the
+    // transaction has committed; see removeFiles().
+    struct Pruned {
+        QList<int> ids;
+        QStringList images;
+        QStringList blobs;
+    };
+
+    ClipboardRetention(QSqlDatabase& db, const QString& imageDir, const ClipboardBlobStore& blobs);
+
+    // Running totals. They are counted from the table once and then kept up
+    // to date by the store through adjustUsage(); invalidateUsage() forces a
+    // recount, e.g. after a rolled back transaction.
+    Usage usage();
+    void adjustUsage(qint64 entries, qint64 bytes);
+    void invalidateUsage() { m_usageKnown = false; }
+
+    // Fills size_bytes for rows written before sizes were tracked.
+    // Returns true while there are rows left to measure.
+    bool backfillSizes(int limit);
+
+    // Same for the stored preview of text rows.
+    bool backfillPreviews(int limit);
+
+    // Deletes at most `limit` of the oldest rows while over either quota.
+    // `overQuota` reports whether another pass is needed.
+    Pruned prune(int maxEntries, qint64 maxBytes, int limit, bool& overQuota);
+    void removeFiles(const Pruned& pruned) const;
+
+    // Removes image, thumbnail and format blob files no row refers to any more.
+    int sweepOrphans();
+
+    void removeImageFiles(const QString& imagePath) const;
+
+    // Format blobs of an entry; collect them before deleting the row and
+    // release them afterwards so blobs still shared by other entries survive.
+    QStringList blobsOf(int id) const;
+    void releaseBlobs(const QStringList& keys) const;
+
+private:
+    QSqlDatabase& m_db;
+    QString m_imageDir;
+    const ClipboardBlobStore& m_blobs;
+    Usage m_usage;
+    bool m_usageKnown = false;
+};
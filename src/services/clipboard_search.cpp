@@ -0,0 +1,216 @@
+#include "clipboard_search.hpp"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <limits>
+
+namespace {
+constexpr auto kConnectionName = "clipboard_search";
+constexpr int kChunkSize = 50;
+constexpr int kScanWindow = 500;
+
+QString likePattern(const QString& query) {
+    QString escaped = query;
+    escaped.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    return '%' + escaped + '%';
+}
+
+QString ftsPhrase(const QString& query) {
+    QString escaped = query;
+    escaped.replace('"', "\"\"");
+    return '"' + escaped + '"';
+}
+
+ClipboardEntry readEntry(const QSqlQuery& sql) {
+    ClipboardEntry entry;
+    entry.id = sql.value(0).toInt();
+    entry.type = sql.value(1).toString();
+    entry.preview = ClipboardModel::makePreview(sql.value(2).toString());
+    entry.imagePath = sql.value(3).toString();
+    entry.timestamp = sql.value(4).toLongLong();
+    const QString formats = sql.value(5).toString();
+    if (!formats.isEmpty()) {
+        entry.formats = formats.split('\n');
+    }
+    return entry;
+}
+}
+
+ClipboardSearcher::ClipboardSearcher(const QString& dbPath, QObject* parent)
+    : QObject(parent)
+    , m_dbPath(dbPath)
+{
+}
+
+ClipboardSearcher::~ClipboardSearcher() {
+    if (m_db.isOpen()) {
+        m_db.close();
+    }
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(kConnectionName);
+}
+
+bool ClipboardSearcher::ensureOpen() {
+    if (m_db.isOpen()) return true;
+
+    if (!QSqlDatabase::contains(kConnectionName)) {
+        m_db = QSqlDatabase::addDatabase("QSQLITE", kConnectionName);
+        m_db.setDatabaseName(m_dbPath);
+        m_db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    } else {
+        m_db = QSqlDatabase::database(kConnectionName, false);
+    }
+    return m_db.open();
+}
+
+void ClipboardSearcher::run(int generation, const QString& query, int limit) {
+    if (isStale(generation)) return;
+    if (!ensureOpen()) {
+        emit resultsReady(generation, {}, true);
+        return;
+    }
+
+    QList<ClipboardEntry> chunk;
+    chunk.reserve(kChunkSize);
+    int found = 0;
+
+    // Emits every full chunk; false once a newer request took over.
+    auto collect = [&](QSqlQuery& sql) {
+        while (sql.next()) {
+            chunk.append(readEntry(sql));
+            ++found;
+            if (chunk.size() == kChunkSize) {
+                if (isStale(generation)) return false;
+                emit resultsReady(generation, chunk, false);
+                chunk.clear();
+            }
+        }
+        return true;
+    };
+
+    // The trigram tokenizer cannot match fewer than three characters. Every
+    // path orders like the history model, so re-copied entries come first.
+    if (query.size() >= 3) {
+        QSqlQuery sql(m_db);
+        sql.setForwardOnly(true);
+        sql.prepare(R"(
+            SELECT h.id, h.type, COALESCE(h.preview, substr(h.content, 1, 101)), h.image_path, h.timestamp,
+                   (SELECT group_concat(mime, char(10)) FROM clipboard_formats WHERE entry_id = h.id)
+            FROM clipboard_fts f JOIN clipboard_history h ON h.id = f.rowid
+            WHERE clipboard_fts MATCH :query
+            ORDER BY h.timestamp DESC, h.id DESC
+            LIMIT :limit
+        )");
+        sql.bindValue(":query", ftsPhrase(query));
+        sql.bindValue(":limit", limit);
+        if (sql.exec()) {
+            if (!collect(sql) || isStale(generation)) return;
+            emit resultsReady(generation, chunk, true);
+            return;
+        }
+    }
+
+    // Anything else is a LIKE scan, which no index can serve. Walk the
+    // history newest first in windows of kScanWindow rows, so matches
+    // stream in order and a newer request stops the scan between windows.
+    // Large bodies only live compressed in content_blob, so match the
+    // index's copy of the text where it exists.
+    const QString pattern = likePattern(query);
+    bool useIndex = true;
+    qint64 cursorTimestamp = std::numeric_limits<qint64>::max();
+    int cursorId = std::numeric_limits<int>::max();
+
+    while (found < limit) {
+        QSqlQuery bound(m_db);
+        bound.setForwardOnly(true);
+        bound.prepare(R"(
+            SELECT timestamp, id FROM clipboard_history
+            WHERE (timestamp, id) < (:timestamp, :id)
+            ORDER BY timestamp DESC, id DESC
+            LIMIT 1 OFFSET :offset
+        )");
+        bound.bindValue(":timestamp", cursorTimestamp);
+        bound.bindValue(":id", cursorId);
+        bound.bindValue(":offset", kScanWindow - 1);
+        if (!bound.exec()) break;
+
+        const bool last = !bound.next();
+        const qint64 boundTimestamp = last ? std::numeric_limits<qint64>::min() : bound.value(0).toLongLong();
+        const int boundId = last ? 0 : bound.value(1).toInt();
+
+        QSqlQuery sql(m_db);
+        sql.setForwardOnly(true);
+        const bool indexed = useIndex;
+        if (indexed) {
+            sql.prepare(R"(
+                SELECT h.id, h.type, COALESCE(h.preview, substr(h.content, 1, 101)), h.image_path, h.timestamp,
+                       (SELECT group_concat(mime, char(10)) FROM clipboard_formats WHERE entry_id = h.id)
+                FROM clipboard_fts f JOIN clipboard_history h ON h.id = f.rowid
+                WHERE (h.timestamp, h.id) < (:timestamp, :id) AND (h.timestamp, h.id) >= (:boundTimestamp, :boundId)
+                  AND f.body LIKE :pattern ESCAPE '\'
+                ORDER BY h.timestamp DESC, h.id DESC
+                LIMIT :limit
+            )");
+            sql.bindValue(":pattern", pattern);
+        } else {
+            sql.prepare(R"(
+                SELECT id, type, COALESCE(preview, substr(content, 1, 101)), image_path, timestamp,
+                       (SELECT group_concat(mime, char(10)) FROM clipboard_formats WHERE entry_id = clipboard_history.id)
+                FROM clipboard_history
+                WHERE (timestamp, id) < (:timestamp, :id) AND (timestamp, id) >= (:boundTimestamp, :boundId)
+                  AND type = 'text' AND (content LIKE :pattern ESCAPE '\' OR preview LIKE :previewPattern ESCAPE '\')
+                ORDER BY timestamp DESC, id DESC
+                LIMIT :limit
+            )");
+            sql.bindValue(":pattern", pattern);
+            sql.bindValue(":previewPattern", pattern);
+        }
+        sql.bindValue(":timestamp", cursorTimestamp);
+        sql.bindValue(":id", cursorId);
+        sql.bindValue(":boundTimestamp", boundTimestamp);
+        sql.bindValue(":boundId", boundId);
+        sql.bindValue(":limit", limit - found);
+
+        if (!sql.exec()) {
+            // Without the search index, retry the window on the history.
+            if (!indexed) break;
+            useIndex = false;
+            continue;
+        }
+        if (!collect(sql) || isStale(generation)) return;
+        if (!chunk.isEmpty()) {
+            emit resultsReady(generation, chunk, false);
+            chunk.clear();
+        }
+
+        if (last) break;
+        cursorTimestamp = boundTimestamp;
+        cursorId = boundId;
+    }
+
+    if (isStale(generation)) return;
+    emit resultsReady(generation, chunk, true);
+}
+
+int ClipboardSearcher::fuzzyScore(QStringView pattern, QStringView text) {
+    if (pattern.isEmpty()) return 0;
+
+    int score = 0;
+    int streak = 0;
+    qsizetype p = 0;
+
+    for (qsizetype i = 0; i < text.size() && p < pattern.size(); ++i) {
+        if (text[i].toCaseFolded() != pattern[p].toCaseFolded()) {
+            streak = 0;
+            continue;
+        }
+
+        score += 1 + streak * 2;
+        if (i == 0 || !text[i - 1].isLetterOrNumber()) {
+            score += 3;
+        }
+        ++streak;
+        ++p;
+    }
+
+    return p == pattern.size() ? score : -1;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <QObject>
+#include <QSqlDatabase>
+#include <QAtomicInt>
+#include <QStringView>
+#include "clipboard_model.hpp"
+
+// Read-only search worker with its own connection. Results are streamed in
+// chunks tagged with the request generation; a newer request makes any
+// running or queued older one bail out at the next chunk or scan window
+// boundary.
+class ClipboardSearcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ClipboardSearcher(const QString& dbPath, QObject* parent = nullptr);
+    ~ClipboardSearcher();
+
+    // Thread-safe; called from the GUI thread before queuing run().
+    void setLatestGeneration(int generation) { m_latest.storeRelease(generation); }
+
+    static int fuzzyScore(QStringView pattern, QStringView text);
+
+public slots:
+    void run(int generation, const QString& query, int limit);
+
+signals:
+    void resultsReady(int generation, const QList<ClipboardEntry>& entries, bool done);
+
+private:
+    bool ensureOpen();
+    bool isStale(int generation) const { return m_latest.loadAcquire() != generation; }
+
+    QString m_dbPath;
+    QSqlDatabase m_db;
+    QAtomicInt m_latest;
+};
@@ -0,0 +1,130 @@
+#include "clipboard_snapshot.hpp"
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+constexpr char kMagic[4] = {'N', 'C', 'S', 'N'};
+constexpr quint32 kVersion = 2;
+constexpr qint64 kHeaderSize = 16;
+constexpr qint64 kRecordSize = 4 + 1 + 1 + 2 + 2 + 2 + 2 + 2 + 8;
+
+template <typename T>
+void put(QByteArray& out, T value) {
+    char buf[sizeof(T)];
+    qToLittleEndian(value, buf);
+    out.append(buf, sizeof(T));
+}
+
+QByteArray clipped(const QString& text) {
+    QByteArray utf8 = text.toUtf8();
+    if (utf8.size() > 0xffff) utf8.truncate(0xffff);
+    return utf8;
+}
+}
+
+namespace ClipboardSnapshot {
+
+QByteArray serialize(const QList<ClipboardEntry>& entries) {
+    const int count = qMin<int>(entries.size(), MaxEntries);
+
+    QByteArray out;
+    out.reserve(kHeaderSize + count * (kRecordSize + 128));
+    out.append(kMagic, sizeof(kMagic));
+    put<quint32>(out, kVersion);
+    put<quint32>(out, quint32(count));
+    put<quint32>(out, 0);
+
+    for (int i = 0; i < count; ++i) {
+        const ClipboardEntry& entry = entries[i];
+        const QByteArray preview = clipped(entry.preview);
+        const QByteArray path = clipped(entry.imagePath);
+        const QByteArray hash = clipped(entry.hash);
+        const QByteArray formats = clipped(entry.formats.join('\n'));
+
+        put<qint32>(out, entry.id);
+        put<quint8>(out, entry.type == "image" ? 1 : 0);
+        put<quint8>(out, 0);
+        put<quint16>(out, quint16(preview.size()));
+        put<quint16>(out, quint16(path.size()));
+        put<quint16>(out, quint16(hash.size()));
+        put<quint16>(out, quint16(formats.size()));
+        put<quint16>(out, 0);
+        put<qint64>(out, entry.timestamp);
+        out.append(preview);
+        out.append(path);
+        out.append(hash);
+        out.append(formats);
+    }
+    return out;
+}
+
+bool parse(const uchar* data, qint64 size, QList<ClipboardEntry>& entries) {
+    if (!data || size < kHeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(data + 4) != kVersion) {
+        return false;
+    }
+
+    const quint32 count = qFromLittleEndian<quint32>(data + 8);
+    if (count > quint32(MaxEntries)) return false;
+
+    QList<ClipboardEntry> parsed;
+    parsed.reserve(count);
+
+    const uchar* p = data + kHeaderSize;
+    const uchar* end = data + size;
+    for (quint32 i = 0; i < count; ++i) {
+        if (end - p < kRecordSize) return false;
+
+        ClipboardEntry entry;
+        entry.id = qFromLittleEndian<qint32>(p);
+        entry.type = p[4] == 1 ? QStringLiteral("image") : QStringLiteral("text");
+        const quint16 previewLen = qFromLittleEndian<quint16>(p + 6);
+        const quint16 pathLen = qFromLittleEndian<quint16>(p + 8);
+        const quint16 hashLen = qFromLittleEndian<quint16>(p + 10);
+        const quint16 formatsLen = qFromLittleEndian<quint16>(p + 12);
+        entry.timestamp = qFromLittleEndian<qint64>(p + 16);
+        p += kRecordSize;
+
+        if (end - p < qint64(previewLen) + pathLen + hashLen + formatsLen) return false;
+        entry.preview = QString::fromUtf8(reinterpret_cast<const char*>(p), previewLen);
+        p += previewLen;
+        entry.imagePath = QString::fromUtf8(reinterpret_cast<const char*>(p), pathLen);
+        p += pathLen;
+        entry.hash = QString::fromLatin1(reinterpret_cast<const char*>(p), hashLen);
+        p += hashLen;
+        if (formatsLen > 0) {
+            entry.formats = QString::fromUtf8(reinterpret_cast<const char*>(p), formatsLen).split('\n');
+        }
+        p += formatsLen;
+
+        parsed.append(entry);
+    }
+
+    entries = parsed;
+    return true;
+}
+
+bool write(const QString& path, const QList<ClipboardEntry>& entries) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(serialize(entries));
+    return file.commit();
+}
+
+bool read(const QString& path, QList<ClipboardEntry>& entries) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = file.size();
+    uchar* data = file.map(0, size);
+    if (!data) return false;
+
+    bool ok = parse(data, size, entries);
+    file.unmap(data);
+    return ok;
+}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "clipboard_model.hpp"
+
+// Compact, versioned image of the newest history rows. It is read straight
+// out of a memory mapping at startup so the list can be shown before the
+// database is open.
+//
+// Layout (little endian):
+//   header  : magic "NCSN", u32 version, u32 count, u32 reserved
+//   records : i32 id, u8 type (0 text, 1 image), u8 pad, u16 previewLen,
+//             u16 pathLen, u16 hashLen, u16 formatsLen, u16 pad, i64 timestamp,
+//             followed by the UTF-8 preview, path, hash and newline separated
+//             format names.
+namespace ClipboardSnapshot {
+constexpr int MaxEntries = 100;
+
+QByteArray serialize(const QList<ClipboardEntry>& entries);
+bool parse(const uchar* data, qint64 size, QList<ClipboardEntry>& entries);
+
+bool write(const QString& path, const QList<ClipboardEntry>& entries);
+bool read(const QString& path, QList<ClipboardEntry>& entries);
+}
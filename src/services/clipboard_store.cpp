@@ -0,0 +1,771 @@
+#include "clipboard_store.hpp"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+#include <QSaveFile>
+#include <QImageWriter>
+#include <QStringDecoder>
+#include "fast_hash.hpp"
+#include "clipboard_image_provider.hpp"
+#include "clipboard_snapshot.hpp"
+
+namespace {
+constexpr auto kConnectionName = "clipboard_writer";
+constexpr int kFlushDelayMs = 30;
+constexpr int kRetentionDelayMs = 2000;
+constexpr int kRetentionChunk = 200;
+constexpr int kSnapshotDelayMs = 1000;
+
+// List rows only read the stored preview (or the head of the content for
+// rows written before previews existed) and the names of the extra formats;
+// bodies are fetched on paste.
+constexpr auto kListColumns =
+    "id, type, COALESCE(preview, substr(content, 1, 101)) AS head, image_path, content_hash, timestamp, "
+    "(SELECT group_concat(mime, char(10)) FROM clipboard_formats WHERE entry_id = clipboard_history.id) AS formats";
+
+// Bodies above this size are stored qCompress'ed in content_blob, and only
+// their first kIndexedChars characters go into the search index. The index
+// keeps its own uncompressed copy, so those bytes count towards size_bytes.
+constexpr int kCompressThreshold = 16 * 1024;
+constexpr int kIndexedChars = 16 * 1024;
+
+ClipboardEntry entryFromQuery(const QSqlQuery& query) {
+    ClipboardEntry entry;
+    entry.id = query.value("id").toInt();
+    entry.type = query.value("type").toString();
+    entry.imagePath = query.value("image_path").toString();
+    entry.hash = query.value("content_hash").toString();
+    entry.timestamp = query.value("timestamp").toLongLong();
+    const QString formats = query.value("formats").toString();
+    if (!formats.isEmpty()) {
+        entry.formats = formats.split('\n');
+    }
+    entry.preview = entry.type == "image" ? QStringLiteral("Image")
+                                          : ClipboardModel::makePreview(query.value("head").toString());
+    return entry;
+}
+}
+
+quint64 clipboardImageDigest(const QImage& image) {
+    FastHash hash;
+    const qint64 header[3] = {image.width(), image.height(), qint64(image.format())};
+    hash.update(header, sizeof(header));
+
+    const size_t rowBytes = (size_t(image.width()) * size_t(image.depth()) + 7) / 8;
+    if (rowBytes == size_t(image.bytesPerLine())) {
+        hash.update(image.constBits(), size_t(image.sizeInBytes()));
+    } else {
+        for (int y = 0; y < image.height(); ++y) {
+            hash.update(image.constScanLine(y), rowBytes);
+        }
+    }
+    return hash.digest();
+}
+
+quint64 clipboardTextDigest(const QString& text) {
+    return FastHash::hash(text.constData(), size_t(text.size()) * sizeof(QChar));
+}
+
+ClipboardStore::ClipboardStore(QObject* parent)
+    : QObject(parent)
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFlushDelayMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &ClipboardStore::flush);
+
+    m_retentionTimer = new QTimer(this);
+    m_retentionTimer->setSingleShot(true);
+    connect(m_retentionTimer, &QTimer::timeout, this, &ClipboardStore::runRetention);
+
+    m_snapshotTimer = new QTimer(this);
+    m_snapshotTimer->setSingleShot(true);
+    m_snapshotTimer->setInterval(kSnapshotDelayMs);
+    connect(m_snapshotTimer, &QTimer::timeout, this, &ClipboardStore::writeSnapshot);
+}
+
+ClipboardStore::~ClipboardStore() {
+    if (!m_pending.isEmpty()) {
+        flush();
+    }
+    if (m_snapshotTimer->isActive()) {
+        writeSnapshot();
+    }
+    if (m_db.isOpen()) {
+        m_db.close();
+    }
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(kConnectionName);
+}
+
+void ClipboardStore::open(const QString& dbPath, const QString& imageDir) {
+    m_imageDir = imageDir;
+    m_snapshotPath = QFileInfo(dbPath).path() + "/clipboard_snapshot.bin";
+    QDir().mkpath(QFileInfo(dbPath).path());
+
+    m_db = QSqlDatabase::addDatabase("QSQLITE", kConnectionName);
+    m_db.setDatabaseName(dbPath);
+
+    if (!m_db.open()) {
+        qWarning() << "Failed to open clipboard database:" << m_db.lastError().text();
+        emit opened(false);
+        return;
+    }
+
+    QSqlQuery pragma(m_db);
+    pragma.exec("PRAGMA journal_mode=WAL");
+    pragma.exec("PRAGMA synchronous=NORMAL");
+
+    migrate();
+    m_blobs = ClipboardBlobStore(QFileInfo(dbPath).path() + "/clipboard_blobs/");
+    m_retention = std::make_unique<ClipboardRetention>(m_db, m_imageDir, m_blobs);
+    m_sweepDue = true;
+    scheduleRetention(0);
+    if (!QFileInfo::exists(m_snapshotPath)) {
+        scheduleSnapshot();
+    }
+    emit opened(true);
+}
+
+void ClipboardStore::migrate() {
+    QSqlQuery query(m_db);
+
+    query.exec(R"(
+        CREATE TABLE IF NOT EXISTS clipboard_history (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            type TEXT NOT NULL,
+            content TEXT,
+            content_hash TEXT,
+            image_path TEXT,
+            timestamp INTEGER NOT NULL
+        )
+    )");
+
+    ensureColumn("content_hash", "TEXT");
+    ensureColumn("size_bytes", "INTEGER");
+    ensureColumn("preview", "TEXT");
+    ensureColumn("content_blob", "BLOB");
+
+    query.exec("CREATE INDEX IF NOT EXISTS idx_timestamp ON clipboard_history(timestamp DESC)");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_hash ON clipboard_history(content_hash)");
+
+    // Extra MIME formats of an entry; the bytes live in the blob store.
+    query.exec(R"(
+        CREATE TABLE IF NOT EXISTS clipboard_formats (
+            entry_id INTEGER NOT NULL,
+            mime TEXT NOT NULL,
+            blob_hash TEXT NOT NULL,
+            size_bytes INTEGER NOT NULL,
+            PRIMARY KEY (entry_id, mime)
+        )
+    )");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_formats_blob ON clipboard_formats(blob_hash)");
+    query.exec(R"(
+        CREATE TRIGGER IF NOT EXISTS clipboard_formats_delete AFTER DELETE ON clipboard_history
+        BEGIN
+            DELETE FROM clipboard_formats WHERE entry_id = old.id;
+        END
+    )");
+
+    migrateSearchIndex();
+}
+
+void ClipboardStore::ensureColumn(const QString& name, const QString& type) {
+    QSqlQuery checkColumn(m_db);
+    checkColumn.exec("PRAGMA table_info(clipboard_history)");
+    while (checkColumn.next()) {
+        if (checkColumn.value(1).toString() == name) {
+            return;
+        }
+    }
+
+    QSqlQuery query(m_db);
+    query.exec(QStringLiteral("ALTER TABLE clipboard_history ADD COLUMN %1 %2").arg(name, type));
+}
+
+void ClipboardStore::migrateSearchIndex() {
+    QSqlQuery query(m_db);
+
+    query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'clipboard_fts'");
+    bool exists = query.next();
+
+    if (!exists && !query.exec("CREATE VIRTUAL TABLE clipboard_fts USING fts5(body, tokenize = 'trigram')")) {
+        qWarning() << "Clipboard search index unavailable:" << query.lastError().text();
+        m_ftsAvailable = false;
+        return;
+    }
+    m_ftsAvailable = true;
+
+    query.exec(R"(
+        CREATE TRIGGER IF NOT EXISTS clipboard_fts_delete AFTER DELETE ON clipboard_history
+        BEGIN
+            DELETE FROM clipboard_fts WHERE rowid = old.id;
+        END
+    )");
+
+    // Backfill with the same prefix new entries get indexed with.
+    if (!exists) {
+        query.prepare("INSERT INTO clipboard_fts (rowid, body) "
+                      "SELECT id, substr(content, 1, :chars) FROM clipboard_history WHERE type = 'text'");
+        query.bindValue(":chars", kIndexedChars);
+        query.exec();
+    }
+}
+
+void ClipboardStore::loadPage(qint64 beforeTimestamp, int beforeId, int limit) {
+    if (beforeId < 0) {
+        QList<ClipboardEntry> entries = readNewest(limit);
+        emit pageLoaded(entries, true, entries.size() == limit);
+        return;
+    }
+
+    QList<ClipboardEntry> entries;
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral(R"(
+        SELECT %1 FROM clipboard_history
+        WHERE timestamp < :ts OR (timestamp = :ts AND id < :id)
+        ORDER BY timestamp DESC, id DESC
+        LIMIT :limit
+    )").arg(kListColumns));
+    query.bindValue(":ts", beforeTimestamp);
+    query.bindValue(":id", beforeId);
+    query.bindValue(":limit", limit);
+
+    if (!query.exec()) {
+        emit pageLoaded(entries, false, false);
+        return;
+    }
+
+    entries.reserve(limit);
+    while (query.next()) {
+        entries.append(entryFromQuery(query));
+    }
+
+    emit pageLoaded(entries, false, entries.size() == limit);
+}
+
+void ClipboardStore::fetchContent(int id) {
+    QSqlQuery query(m_db);
+    query.prepare("SELECT content, content_blob FROM clipboard_history WHERE id = :id");
+    query.bindValue(":id", id);
+
+    if (!query.exec() || !query.next()) return;
+
+    QString content;
+    const QByteArray blob = query.value(1).toByteArray();
+    if (!blob.isEmpty()) {
+        content = QString::fromUtf8(qUncompress(blob));
+    } else {
+        content = query.value(0).toString();
+    }
+    query.finish();
+
+    // Only file paths are handed out; the bytes are read when a paste target
+    // actually asks for the format.
+    QVariantMap formats;
+    QSqlQuery formatQuery(m_db);
+    formatQuery.prepare("SELECT mime, blob_hash FROM clipboard_formats WHERE entry_id = :id");
+    formatQuery.bindValue(":id", id);
+    if (formatQuery.exec()) {
+        while (formatQuery.next()) {
+            formats.insert(formatQuery.value(0).toString(),
+                           m_blobs.pathFor(formatQuery.value(1).toString()));
+        }
+    }
+
+    emit contentReady(id, content, formats);
+}
+
+void ClipboardStore::fetchFormat(int id, const QString& mime) {
+    QSqlQuery query(m_db);
+    query.prepare("SELECT blob_hash FROM clipboard_formats WHERE entry_id = :id AND mime = :mime");
+    query.bindValue(":id", id);
+    query.bindValue(":mime", mime);
+
+    QString text;
+    if (query.exec() && query.next()) {
+        const QByteArray data = m_blobs.read(query.value(0).toString());
+        if (mime == "text/html") {
+            QStringDecoder decoder = QStringDecoder::decoderForHtml(data);
+            text = decoder.isValid() ? QString(decoder(data)) : QString::fromUtf8(data);
+        } else if (mime.startsWith("text/") || mime.startsWith("application/x-kde")
+                   || mime.startsWith("x-special/")) {
+            text = QString::fromUtf8(data);
+        }
+    }
+    emit formatReady(id, mime, text);
+}
+
+void ClipboardStore::setMaxEntries(int max) {
+    if (max <= 0) return;
+    m_maxEntries = max;
+    scheduleRetention(0);
+}
+
+void ClipboardStore::setMaxBytes(qint64 max) {
+    if (max <= 0) return;
+    m_maxBytes = max;
+    scheduleRetention(0);
+}
+
+void ClipboardStore::storeText(const QString& text, const QString& hash,
+                               const QList<ClipboardFormat>& formats) {
+    PendingWrite write;
+    write.text = text;
+    write.hash = hash;
+    write.formats = formats;
+    m_pending.append(write);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void ClipboardStore::touchEntry(int id, const QList<ClipboardFormat>& formats) {
+    PendingWrite write;
+    write.touchId = id;
+    write.formats = formats;
+    m_pending.append(write);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void ClipboardStore::storeImage(const QImage& image, const QString& hash,
+                                const QList<ClipboardFormat>& formats) {
+    PendingWrite write;
+    write.image = image;
+    write.hash = hash;
+    write.formats = formats;
+    m_pending.append(write);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void ClipboardStore::storeEncodedImage(const QByteArray& png, const QString& hash,
+                                       const QList<ClipboardFormat>& formats) {
+    PendingWrite write;
+    write.png = png;
+    write.hash = hash;
+    write.formats = formats;
+    m_pending.append(write);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void ClipboardStore::flush() {
+    if (m_pending.isEmpty() || !m_db.isOpen()) return;
+
+    QList<PendingWrite> batch;
+    batch.swap(m_pending);
+
+    if (!m_db.transaction()) {
+        qWarning() << "Clipboard batch could not start a transaction:" << m_db.lastError().text();
+        batch.append(m_pending);
+        m_pending.swap(batch);
+        m_flushTimer->start();
+        return;
+    }
+
+    QList<ClipboardEntry> stored;
+    QStringList releasedBlobs;
+    for (const PendingWrite& write : batch) {
+        int id = -1;
+        if (write.touchId >= 0) {
+            id = writeTouch(write.touchId, stored);
+        } else if (!write.image.isNull() || !write.png.isEmpty()) {
+            id = writeImage(write.image, write.png, write.hash, stored);
+        } else {
+            id = writeText(write.text, write.hash, stored);
+        }
+        // The formats of the latest copy replace whatever the entry had.
+        if (id >= 0 && writeFormats(id, write.formats, releasedBlobs) && !stored.isEmpty()
+            && stored.last().id == id) {
+            stored.last().formats.clear();
+            for (const ClipboardFormat& format : write.formats) {
+                stored.last().formats.append(format.mime);
+            }
+        }
+    }
+
+    if (!m_db.commit()) {
+        qWarning() << "Clipboard batch commit failed:" << m_db.lastError().text();
+        m_db.rollback();
+        if (m_retention) m_retention->invalidateUsage();
+        return;
+    }
+
+    // Replaced format blobs may only go once the rows no longer use them.
+    if (m_retention) m_retention->releaseBlobs(releasedBlobs);
+    for (const ClipboardEntry& entry : std::as_const(stored)) {
+        emit entryStored(entry);
+    }
+
+    if (!m_retentionTimer->isActive()) {
+        scheduleRetention(kRetentionDelayMs);
+    }
+    scheduleSnapshot();
+}
+
+int ClipboardStore::writeText(const QString& text, const QString& hash, QList<ClipboardEntry>& stored) {
+    qint64 timestamp = QDateTime::currentSecsSinceEpoch();
+
+    int existingId = touchExisting("text", hash, timestamp, stored);
+    if (existingId >= 0) {
+        return existingId;
+    }
+
+    const QByteArray utf8 = text.toUtf8();
+    const QString preview = ClipboardModel::makePreview(text);
+    const bool compress = utf8.size() > kCompressThreshold;
+    const QByteArray blob = compress ? qCompress(utf8) : QByteArray();
+    const QString indexed = text.left(kIndexedChars);
+    qint64 indexedBytes = 0;
+    if (m_ftsAvailable) {
+        indexedBytes = indexed.size() == text.size() ? utf8.size() : indexed.toUtf8().size();
+    }
+
+    QSqlQuery query(m_db);
+    query.prepare(R"(
+        INSERT INTO clipboard_history (type, content, content_blob, preview, content_hash, size_bytes, timestamp)
+        VALUES ('text', :content, :blob, :preview, :hash, :size, :timestamp)
+    )");
+    query.bindValue(":content", compress ? QVariant(QMetaType::fromType<QString>()) : QVariant(text));
+    query.bindValue(":blob", compress ? QVariant(blob) : QVariant(QMetaType::fromType<QByteArray>()));
+    query.bindValue(":preview", preview);
+    const qint64 size = (compress ? blob.size() : utf8.size()) + indexedBytes;
+    query.bindValue(":size", size);
+    query.bindValue(":hash", hash);
+    query.bindValue(":timestamp", timestamp);
+
+    if (query.exec()) {
+        ClipboardEntry entry;
+        entry.id = query.lastInsertId().toInt();
+        if (m_retention) m_retention->adjustUsage(1, size);
+
+        if (m_ftsAvailable) {
+            QSqlQuery indexQuery(m_db);
+            indexQuery.prepare("INSERT INTO clipboard_fts (rowid, body) VALUES (:id, :body)");
+            indexQuery.bindValue(":id", entry.id);
+            indexQuery.bindValue(":body", indexed);
+            indexQuery.exec();
+        }
+
+        entry.type = "text";
+        entry.preview = preview;
+        entry.hash = hash;
+        entry.timestamp = timestamp;
+        stored.append(entry);
+        return entry.id;
+    }
+    return -1;
+}
+
+int ClipboardStore::writeImage(const QImage& image, const QByteArray& png, const QString& hash,
+                               QList<ClipboardEntry>& stored) {
+    qint64 timestamp = QDateTime::currentSecsSinceEpoch();
+    int existingId = touchExisting("image", hash, timestamp, stored);
+    if (existingId >= 0) {
+        return existingId;
+    }
+
+    QDir().mkpath(m_imageDir);
+    QString fullPath = m_imageDir + hash + ".png";
+    bool encoded = false;
+
+    if (!QFileInfo::exists(fullPath)) {
+        QSaveFile file(fullPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return -1;
+        }
+        if (!png.isEmpty()) {
+            // Already PNG encoded by the source; store the bytes untouched.
+            if (file.write(png) != png.size() || !file.commit()) {
+                return -1;
+            }
+        } else {
+            QImageWriter writer(&file, "png");
+            if (!writer.write(image) || !file.commit()) {
+                return -1;
+            }
+        }
+        encoded = true;
+    }
+
+    // Without a decoded image the provider builds the thumbnail on first use.
+    QString thumbPath = ClipboardImageProvider::thumbnailPath(m_imageDir, hash);
+    if (!image.isNull() && !QFileInfo::exists(thumbPath)) {
+        ClipboardImageProvider::makeThumbnail(image).save(thumbPath, "png");
+    }
+
+    QSqlQuery query(m_db);
+    query.prepare(R"(
+        INSERT INTO clipboard_history (type, content_hash, image_path, size_bytes, timestamp)
+        VALUES ('image', :hash, :path, :size, :timestamp)
+    )");
+    const qint64 size = QFileInfo(fullPath).size() + QFileInfo(thumbPath).size();
+    query.bindValue(":hash", hash);
+    query.bindValue(":size", size);
+    query.bindValue(":path", fullPath);
+    query.bindValue(":timestamp", timestamp);
+
+    if (query.exec()) {
+        ClipboardEntry entry;
+        entry.id = query.lastInsertId().toInt();
+        if (m_retention) m_retention->adjustUsage(1, size);
+        entry.type = "image";
+        entry.imagePath = fullPath;
+        entry.hash = hash;
+        entry.preview = QStringLiteral("Image");
+        entry.timestamp = timestamp;
+        stored.append(entry);
+        return entry.id;
+    }
+
+    if (encoded) {
+        QFile::remove(fullPath);
+    }
+    return -1;
+}
+
+bool ClipboardStore::writeFormats(int id, const QList<ClipboardFormat>& formats, QStringList& releasedBlobs) {
+    QSqlQuery existing(m_db);
+    existing.prepare("SELECT blob_hash, size_bytes FROM clipboard_formats WHERE entry_id = :id");
+    existing.bindValue(":id", id);
+    QStringList oldBlobs;
+    qint64 oldBytes = 0;
+    if (existing.exec()) {
+        while (existing.next()) {
+            oldBlobs.append(existing.value(0).toString());
+            oldBytes += existing.value(1).toLongLong();
+        }
+    }
+    if (oldBlobs.isEmpty() && formats.isEmpty()) return false;
+
+    QSqlQuery clear(m_db);
+    clear.prepare("DELETE FROM clipboard_formats WHERE entry_id = :id");
+    clear.bindValue(":id", id);
+    clear.exec();
+
+    QSqlQuery insert(m_db);
+    insert.prepare(R"(
+        INSERT OR REPLACE INTO clipboard_formats (entry_id, mime, blob_hash, size_bytes)
+        VALUES (:id, :mime, :hash, :size)
+    )");
+    qint64 newBytes = 0;
+    for (const ClipboardFormat& format : formats) {
+        const QString key = m_blobs.put(format.data);
+        if (key.isEmpty()) continue;
+
+        insert.bindValue(":id", id);
+        insert.bindValue(":mime", format.mime);
+        insert.bindValue(":hash", key);
+        insert.bindValue(":size", format.data.size());
+        if (insert.exec()) {
+            newBytes += format.data.size();
+        }
+    }
+
+    // Shared blobs are charged to every entry that uses them, which keeps
+    // the byte quota conservative.
+    QSqlQuery size(m_db);
+    size.prepare("UPDATE clipboard_history SET size_bytes = COALESCE(size_bytes, 0) + :delta WHERE id = :id");
+    size.bindValue(":delta", newBytes - oldBytes);
+    size.bindValue(":id", id);
+    if (size.exec() && m_retention) {
+        m_retention->adjustUsage(0, newBytes - oldBytes);
+    }
+
+    releasedBlobs += oldBlobs;
+    return true;
+}
+
+int ClipboardStore::writeTouch(int id, QList<ClipboardEntry>& stored) {
+    QSqlQuery updateQuery(m_db);
+    updateQuery.prepare("UPDATE clipboard_history SET timestamp = :timestamp WHERE id = :id");
+    updateQuery.bindValue(":timestamp", QDateTime::currentSecsSinceEpoch());
+    updateQuery.bindValue(":id", id);
+
+    if (!updateQuery.exec() || updateQuery.numRowsAffected() <= 0) {
+        return -1;
+    }
+
+    ClipboardEntry entry = readEntry(id);
+    if (entry.id >= 0) stored.append(entry);
+    return id;
+}
+
+int ClipboardStore::touchExisting(const QString& type, const QString& hash, qint64 timestamp,
+                                  QList<ClipboardEntry>& stored) {
+    QSqlQuery checkQuery(m_db);
+    checkQuery.prepare("SELECT id FROM clipboard_history WHERE content_hash = :hash AND type = :type LIMIT 1");
+    checkQuery.bindValue(":hash", hash);
+    checkQuery.bindValue(":type", type);
+
+    if (!checkQuery.exec() || !checkQuery.next()) {
+        return -1;
+    }
+
+    int existingId = checkQuery.value(0).toInt();
+    QSqlQuery updateQuery(m_db);
+    updateQuery.prepare("UPDATE clipboard_history SET timestamp = :timestamp WHERE id = :id");
+    updateQuery.bindValue(":timestamp", timestamp);
+    updateQuery.bindValue(":id", existingId);
+
+    if (updateQuery.exec()) {
+        ClipboardEntry entry = readEntry(existingId);
+        if (entry.id >= 0) stored.append(entry);
+    }
+    return existingId;
+}
+
+void ClipboardStore::scheduleRetention(int delayMs) {
+    m_retentionTimer->start(delayMs);
+}
+
+void ClipboardStore::runRetention() {
+    if (!m_retention || !m_db.isOpen()) return;
+    flush();
+
+    if (!m_db.transaction()) {
+        qWarning() << "Clipboard retention could not start a transaction:" << m_db.lastError().text();
+        scheduleRetention(kRetentionDelayMs);
+        return;
+    }
+    bool moreBackfill = m_retention->backfillSizes(kRetentionChunk);
+    moreBackfill |= m_retention->backfillPreviews(kRetentionChunk);
+    bool overQuota = false;
+    const ClipboardRetention::Pruned pruned = m_retention->prune(m_maxEntries, m_maxBytes, kRetentionChunk,
+                                                                 overQuota);
+    if (!m_db.commit()) {
+        qWarning() << "Clipboard retention commit failed:" << m_db.lastError().text();
+        m_db.rollback();
+        m_retention->invalidateUsage();
+        scheduleRetention(kRetentionDelayMs);
+        return;
+    }
+
+    // Only now are the rows really gone, so their files can follow.
+    m_retention->removeFiles(pruned);
+    for (int id : pruned.ids) {
+        emit entryRemoved(id);
+    }
+    if (!pruned.ids.isEmpty()) {
+        scheduleSnapshot();
+    }
+
+    if (m_sweepDue) {
+        m_sweepDue = false;
+        m_retention->sweepOrphans();
+    }
+
+    ClipboardRetention::Usage usage = m_retention->usage();
+    emit storageChanged(usage.entries, usage.bytes);
+
+    if (moreBackfill || (overQuota && !pruned.ids.isEmpty())) {
+        scheduleRetention(0);
+    } else if (overQuota) {
+        scheduleRetention(kRetentionDelayMs);
+    }
+}
+
+void ClipboardStore::scheduleSnapshot() {
+    if (!m_snapshotTimer->isActive()) {
+        m_snapshotTimer->start();
+    }
+}
+
+void ClipboardStore::writeSnapshot() {
+    m_snapshotTimer->stop();
+    if (m_snapshotPath.isEmpty() || !m_db.isOpen()) return;
+
+    ClipboardSnapshot::write(m_snapshotPath, readNewest(ClipboardSnapshot::MaxEntries));
+}
+
+QList<ClipboardEntry> ClipboardStore::readNewest(int limit) {
+    QList<ClipboardEntry> entries;
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral(R"(
+        SELECT %1 FROM clipboard_history
+        ORDER BY timestamp DESC, id DESC
+        LIMIT :limit
+    )").arg(kListColumns));
+    query.bindValue(":limit", limit);
+
+    if (query.exec()) {
+        while (query.next()) {
+            entries.append(entryFromQuery(query));
+        }
+    }
+    return entries;
+}
+
+ClipboardEntry ClipboardStore::readEntry(int id) {
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral("SELECT %1 FROM clipboard_history WHERE id = :id").arg(kListColumns));
+    query.bindValue(":id", id);
+    if (!query.exec() || !query.next()) return {};
+    return entryFromQuery(query);
+}
+
+void ClipboardStore::removeEntry(int id) {
+    flush();
+
+    QSqlQuery lookup(m_db);
+    lookup.prepare("SELECT type, image_path, COALESCE(size_bytes, 0) FROM clipboard_history WHERE id = :id");
+    lookup.bindValue(":id", id);
+    QString imagePath;
+    qint64 size = 0;
+    if (lookup.exec() && lookup.next()) {
+        if (lookup.value(0).toString() == "image") imagePath = lookup.value(1).toString();
+        size = lookup.value(2).toLongLong();
+    }
+    lookup.finish();
+    const QStringList blobs = m_retention ? m_retention->blobsOf(id) : QStringList();
+
+    QSqlQuery query(m_db);
+    query.prepare("DELETE FROM clipboard_history WHERE id = :id");
+    query.bindValue(":id", id);
+
+    if (query.exec()) {
+        if (m_retention) {
+            if (query.numRowsAffected() > 0) m_retention->adjustUsage(-1, -size);
+            m_retention->removeImageFiles(imagePath);
+            m_retention->releaseBlobs(blobs);
+        }
+        emit entryRemoved(id);
+        scheduleRetention(kRetentionDelayMs);
+        scheduleSnapshot();
+    }
+}
+
+void ClipboardStore::wipe() {
+    m_pending.clear();
+    m_flushTimer->stop();
+
+    QDir dir(m_imageDir);
+    dir.removeRecursively();
+    QDir(m_blobs.directory()).removeRecursively();
+
+    QSqlQuery query(m_db);
+    if (!query.exec("DELETE FROM clipboard_history")) {
+        return;
+    }
+
+    query.exec("DELETE FROM sqlite_sequence WHERE name='clipboard_history'");
+
+    query.exec("VACUUM");
+    if (m_retention) m_retention->invalidateUsage();
+
+    emit wiped();
+    emit storageChanged(0, 0);
+    writeSnapshot();
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <QObject>
+#include <QSqlDatabase>
+#include <QImage>
+#include <QList>
+#include <QTimer>
+#include <QVariantMap>
+#include <memory>
+#include "clipboard_model.hpp"
+#include "clipboard_retention.hpp"
+#include "clipboard_blob_store.hpp"
+
+// One extra MIME format offered alongside the main text or image payload,
+// kept as the raw bytes the source application provided.
+struct ClipboardFormat {
+    QString mime;
+    QByteArray data;
+};
+Q_DECLARE_METATYPE(ClipboardFormat)
+
+// Images are content addressed: the file name is the FastHash of the raw
+// pixel buffer, so identical screenshots share one PNG and one row. When the
+// source offers image/png the encoded bytes are hashed and stored instead.
+quint64 clipboardImageDigest(const QImage& image);
+
+// Text is keyed by the FastHash of its UTF-16 code units.
+quint64 clipboardTextDigest(const QString& text);
+
+// Owns the clipboard database on a dedicated thread. All slots are meant to
+// be invoked through queued calls; results are reported once committed.
+class ClipboardStore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ClipboardStore(QObject* parent = nullptr);
+    ~ClipboardStore();
+
+public slots:
+    void open(const QString& dbPath, const QString& imageDir);
+    void loadPage(qint64 beforeTimestamp, int beforeId, int limit);
+    void fetchContent(int id);
+    void setMaxEntries(int max);
+    void setMaxBytes(qint64 max);
+    void fetchFormat(int id, const QString& mime);
+    void storeText(const QString& text, const QString& hash, const QList<ClipboardFormat>& formats);
+    void touchEntry(int id, const QList<ClipboardFormat>& formats);
+    void storeImage(const QImage& image, const QString& hash, const QList<ClipboardFormat>& formats);
+    void storeEncodedImage(const QByteArray& png, const QString& hash, const QList<ClipboardFormat>& formats);
+    void removeEntry(int id);
+    void wipe();
+
+signals:
+    void opened(bool ok);
+    void pageLoaded(const QList<ClipboardEntry>& entries, bool reset, bool hasMore);
+    void contentReady(int id, const QString& content, const QVariantMap& formatFiles);
+    void formatReady(int id, const QString& mime, const QString& text);
+    void entryStored(const ClipboardEntry& entry);
+    void entryRemoved(int id);
+    void wiped();
+    void storageChanged(qint64 entries, qint64 bytes);
+
+private:
+    struct PendingWrite {
+        QString text;
+        QImage image;
+        QByteArray png;
+        QString hash;
+        int touchId = -1;
+        QList<ClipboardFormat> formats;
+    };
+
+    void migrate();
+    void ensureColumn(const QString& name, const QString& type);
+    void migrateSearchIndex();
+    void flush();
+    int writeText(const QString& text, const QString& hash, QList<ClipboardEntry>& stored);
+    int writeTouch(int id, QList<ClipboardEntry>& stored);
+    int writeImage(const QImage& image, const QByteArray& png, const QString& hash,
+                   QList<ClipboardEntry>& stored);
+    // Blobs the entry no longer uses are added to `releasedBlobs`; the caller
+    // releases them after the transaction has committed.
+    bool writeFormats(int id, const QList<ClipboardFormat>& formats, QStringList& releasedBlobs);
+    void scheduleRetention(int delayMs);
+    void scheduleSnapshot();
+    void writeSnapshot();
+    QList<ClipboardEntry> readNewest(int limit);
+    void runRetention();
+    int touchExisting(const QString& type, const QString& hash, qint64 timestamp,
+                      QList<ClipboardEntry>& stored);
+    ClipboardEntry readEntry(int id);
+
+    QSqlDatabase m_db;
+    QString m_imageDir;
+    QTimer* m_flushTimer;
+    QTimer* m_retentionTimer;
+    QTimer* m_snapshotTimer;
+    QString m_snapshotPath;
+    QList<PendingWrite> m_pending;
+    ClipboardBlobStore m_blobs;
+    std::unique_ptr<ClipboardRetention> m_retention;
+    int m_maxEntries = 10000;
+    qint64 m_maxBytes = 512ll * 1024 * 1024;
+    bool m_sweepDue = false;
+    bool m_ftsAvailable = false;
+};
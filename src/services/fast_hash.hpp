@@ -0,0 +1,138 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QtEndian>
+#include <cstring>
+
+// Streaming XXH64. Used to fingerprint clipboard payloads; not suitable for
+// anything security related.
+class FastHash {
+public:
+    explicit FastHash(quint64 seed = 0) { reset(seed); }
+
+    void reset(quint64 seed = 0) {
+        m_v[0] = seed + P1 + P2;
+        m_v[1] = seed + P2;
+        m_v[2] = seed;
+        m_v[3] = seed - P1;
+        m_seed = seed;
+        m_total = 0;
+        m_bufferSize = 0;
+    }
+
+    void update(const void* data, size_t len) {
+        const uchar* p = static_cast<const uchar*>(data);
+        const uchar* end = p + len;
+        m_total += len;
+
+        if (m_bufferSize + len < 32) {
+            std::memcpy(m_buffer + m_bufferSize, p, len);
+            m_bufferSize += len;
+            return;
+        }
+
+        if (m_bufferSize > 0) {
+            size_t fill = 32 - m_bufferSize;
+            std::memcpy(m_buffer + m_bufferSize, p, fill);
+            consumeStripe(m_buffer);
+            p += fill;
+            m_bufferSize = 0;
+        }
+
+        while (end - p >= 32) {
+            consumeStripe(p);
+            p += 32;
+        }
+
+        if (p < end) {
+            m_bufferSize = static_cast<size_t>(end - p);
+            std::memcpy(m_buffer, p, m_bufferSize);
+        }
+    }
+
+    void update(const QByteArray& data) { update(data.constData(), size_t(data.size())); }
+
+    quint64 digest() const {
+        quint64 h;
+        if (m_total >= 32) {
+            h = rotl(m_v[0], 1) + rotl(m_v[1], 7) + rotl(m_v[2], 12) + rotl(m_v[3], 18);
+            for (quint64 v : m_v) {
+                h = mergeRound(h, v);
+            }
+        } else {
+            h = m_seed + P5;
+        }
+        h += m_total;
+
+        const uchar* p = m_buffer;
+        const uchar* end = m_buffer + m_bufferSize;
+        while (end - p >= 8) {
+            h ^= round(0, qFromLittleEndian<quint64>(p));
+            h = rotl(h, 27) * P1 + P4;
+            p += 8;
+        }
+        if (end - p >= 4) {
+            h ^= quint64(qFromLittleEndian<quint32>(p)) * P1;
+            h = rotl(h, 23) * P2 + P3;
+            p += 4;
+        }
+        while (p < end) {
+            h ^= quint64(*p++) * P5;
+            h = rotl(h, 11) * P1;
+        }
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    QString hexDigest() const {
+        return toHex(digest());
+    }
+
+    static QString toHex(quint64 digest) {
+        return QStringLiteral("%1").arg(digest, 16, 16, QLatin1Char('0'));
+    }
+
+    static quint64 hash(const void* data, size_t len, quint64 seed = 0) {
+        FastHash h(seed);
+        h.update(data, len);
+        return h.digest();
+    }
+
+private:
+    static constexpr quint64 P1 = 11400714785074694791ULL;
+    static constexpr quint64 P2 = 14029467366897019727ULL;
+    static constexpr quint64 P3 = 1609587929392839161ULL;
+    static constexpr quint64 P4 = 9650029242287828579ULL;
+    static constexpr quint64 P5 = 2870177450012600261ULL;
+
+    static quint64 rotl(quint64 x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static quint64 round(quint64 acc, quint64 input) {
+        acc += input * P2;
+        acc = rotl(acc, 31);
+        return acc * P1;
+    }
+
+    static quint64 mergeRound(quint64 acc, quint64 val) {
+        acc ^= round(0, val);
+        return acc * P1 + P4;
+    }
+
+    void consumeStripe(const uchar* p) {
+        m_v[0] = round(m_v[0], qFromLittleEndian<quint64>(p));
+        m_v[1] = round(m_v[1], qFromLittleEndian<quint64>(p + 8));
+        m_v[2] = round(m_v[2], qFromLittleEndian<quint64>(p + 16));
+        m_v[3] = round(m_v[3], qFromLittleEndian<quint64>(p + 24));
+    }
+
+    quint64 m_v[4];
+    quint64 m_seed;
+    quint64 m_total;
+    uchar m_buffer[32];
+    size_t m_bufferSize;
+};
@@ -1,18 +1,90 @@
 #include "resources.hpp"
-#include <QFile>
-#include <QTextStream>
-#include <QDir>
-#include <QDebug>
-#include <QProcess>
-#include <QTimer>
-#include <sys/sysinfo.h>
+#include "resources_consumer.hpp"
+#include "resources_sampler.hpp"
+#include <QDateTime>
+#include <QHash>
+#include <initializer_list>
+#include <iterator>
+
+namespace {
+constexpr int kMinIntervalMs = 250;
+
+// Indexed by ResourcesSampler::Group.
+const char *const kGroupNames[] = {"cpu", "memory", "thermal", "gpu", "processes", "disk", "network", "pressure", "gpu_clients"};
+constexpr int kDefaultIntervalsMs[] = {2000, 2000, 2000, 2000, 3000, 2000, 2000, 2000, 3000};
+static_assert(std::size(kGroupNames) == ResourcesSampler::GroupCount);
+static_assert(std::size(kDefaultIntervalsMs) == ResourcesSampler::GroupCount);
+
+constexpr double kPowerEpsilonW = 0.5;
+constexpr double kFanEpsilonRpm = 50.0;
+constexpr double kVoltageEpsilonV = 0.01;
+constexpr double kCurrentEpsilonA = 0.05;
+
+struct Reading {
+    const char *key;
+    double epsilon;
+};
+
+bool readingsMoved(const QVariantMap &published, const QVariantMap &next, std::initializer_list<Reading> readings)
+{
+    for (const Reading &reading : readings) {
+        if (movedPast(published.value(reading.key).toDouble(), next.value(reading.key).toDouble(),
+                      reading.epsilon)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString identityOf(const QVariantMap &item, std::initializer_list<const char *> identity)
+{
+    QString key;
+    for (const char *field : identity) {
+        key += item.value(field).toString();
+        key += QChar(0);
+    }
+    return key;
+}
+
+// True when a list of devices (or clients) should be republished: one was
+// added or removed, matched by the `identity` fields, or one of its readings
+// moved past its epsilon. A change of order alone does not count.
+bool listMoved(const QVariantList &published, const QVariantList &next,
+               std::initializer_list<const char *> identity, std::initializer_list<Reading> readings)
+{
+    if (published.size() != next.size()) return true;
+
+    QHash<QString, QVariantMap> byIdentity;
+    byIdentity.reserve(published.size());
+    for (const QVariant &item : published) {
+        const QVariantMap map = item.toMap();
+        byIdentity.insert(identityOf(map, identity), map);
+    }
+    for (const QVariant &item : next) {
+        const QVariantMap map = item.toMap();
+        const auto it = byIdentity.constFind(identityOf(map, identity));
+        if (it == byIdentity.cend() || readingsMoved(it.value(), map, readings)) return true;
+    }
+    return false;
+}
+
+int groupIndex(const QString &name)
+{
+    for (int i = 0; i < ResourcesSampler::GroupCount; ++i) {
+        if (name == QLatin1String(kGroupNames[i])) return i;
+    }
+    return -1;
+}
+}
 
 ResourcesService* ResourcesService::s_instance = nullptr;
 
 ResourcesService::ResourcesService(QObject *parent)
     : QObject(parent)
-    , m_prevTotal(0)
-    , m_prevIdle(0)
+    , m_cores(new CpuCoreModel(this))
+    , m_history(new ResourcesHistory(this))
+    , m_topCpu(new ProcessListModel(this))
+    , m_topMemory(new ProcessListModel(this))
 {
     m_stats = QVariantMap{
         {"cpu_percent", 0.0},
@@ -22,14 +94,39 @@ ResourcesService::ResourcesService(QObject *parent)
         {"mem_available", 0},
         {"swap_total", 0},
         {"swap_free", 0},
-        {"gpus", QVariantList()}
+        {"mem_cached", 0},
+        {"mem_dirty", 0},
+        {"gpus", QVariantList()},
+        {"gpu_clients", QVariantList()},
+        {"disks", QVariantList()},
+        {"network", QVariantList()},
+        {"pressure", QVariantMap()}
     };
 
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout, this, &ResourcesService::updateStats);
-    m_updateTimer->start(2000);
+    m_cores->setEpsilons(float(m_percentEpsilon), float(m_frequencyEpsilon));
+    updateProcessEpsilons();
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName("ResourcesSampler");
+    m_sampler = new ResourcesSampler(qEnvironmentVariable("NOON_RESOURCES_ROOT"));
+    m_sampler->moveToThread(m_thread);
 
-    updateStats();
+    connect(m_thread, &QThread::finished, m_sampler, &QObject::deleteLater);
+    connect(m_sampler, &ResourcesSampler::sampled, this, &ResourcesService::onSampled);
+    connect(m_sampler, &ResourcesSampler::processesSampled, this, &ResourcesService::onProcessesSampled);
+    connect(m_sampler, &ResourcesSampler::sensorsDiscovered, this, &ResourcesService::onSensorsDiscovered);
+    connect(m_sampler, &ResourcesSampler::sensorsSampled, this, &ResourcesService::onSensorsSampled);
+
+    m_intervals = QList<int>(ResourcesSampler::GroupCount, 0);
+    m_thread->start();
+    reschedule();
+}
+
+ResourcesService::~ResourcesService()
+{
+    QMetaObject::invokeMethod(m_sampler, "stop", Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
 }
 
 ResourcesService* ResourcesService::instance()
@@ -49,131 +146,402 @@ ResourcesService* ResourcesService::create(QQmlEngine *qmlEngine, QJSEngine *jsE
     return inst;
 }
 
-void ResourcesService::updateStats()
+void ResourcesService::setPaused(bool paused)
 {
-    double cpuPercent = 0.0, cpuFreqGhz = 0.0, cpuTemp = 0.0;
-    quint64 memTotal = 0, memAvailable = 0;
-    quint64 swapTotal = 0, swapFree = 0;
+    if (m_paused == paused) return;
+    m_paused = paused;
+    reschedule();
+    emit pausedChanged();
+}
 
-    readCpuStats(cpuPercent, cpuFreqGhz, cpuTemp);
-    readMemoryAndSwapStats(memTotal, memAvailable, swapTotal, swapFree);
-    QVariantList gpus = readGpuStats();
+void ResourcesService::updateConsumer(ResourcesConsumer *consumer)
+{
+    m_consumers.insert(consumer);
+    m_consumerSeen = true;
+    reschedule();
+}
 
-    m_stats = QVariantMap{
-        {"cpu_percent", cpuPercent},
-        {"cpu_freq_ghz", cpuFreqGhz},
-        {"cpu_temp", cpuTemp},
-        {"mem_total", static_cast<qint64>(memTotal)},
-        {"mem_available", static_cast<qint64>(memAvailable)},
-        {"swap_total", static_cast<qint64>(swapTotal)},
-        {"swap_free", static_cast<qint64>(swapFree)},
-        {"gpus", gpus}
-    };
+void ResourcesService::removeConsumer(ResourcesConsumer *consumer)
+{
+    if (m_consumers.remove(consumer)) reschedule();
+}
 
-    emit statsChanged();
-}
-
-void ResourcesService::readCpuStats(double &cpuPercent, double &cpuFreqGhz, double &cpuTemp)
-{
-    // 1. CPU Usage: Parse /proc/stat
-    QFile statFile("/proc/stat");
-    if (statFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QString line = statFile.readLine();
-        QStringList parts = line.simplified().split(' ');
-        if (parts.size() >= 5) {
-            quint64 user = parts[1].toULongLong();
-            quint64 nice = parts[2].toULongLong();
-            quint64 system = parts[3].toULongLong();
-            quint64 idle = parts[4].toULongLong();
-            quint64 iowait = parts.size() > 5 ? parts[5].toULongLong() : 0;
-
-            quint64 total = user + nice + system + idle + iowait;
-            if (m_prevTotal != 0) {
-                double totalDiff = static_cast<double>(total - m_prevTotal);
-                double idleDiff = static_cast<double>(idle - m_prevIdle);
-                if (totalDiff > 0) {
-                    cpuPercent = 100.0 * (totalDiff - idleDiff) / totalDiff;
-                }
-            }
-            m_prevTotal = total;
-            m_prevIdle = idle;
+void ResourcesService::reschedule()
+{
+    QList<int> intervals(ResourcesSampler::GroupCount, 0);
+    if (!m_paused && !m_consumerSeen) {
+        // QML written before ResourcesConsumer existed only binds the
+        // properties, so keep sampling what the service always did until
+        // the first consumer shows up.
+        for (int group : {ResourcesSampler::Cpu, ResourcesSampler::Memory,
+                          ResourcesSampler::Thermal, ResourcesSampler::Gpu}) {
+            intervals[group] = kDefaultIntervalsMs[group];
         }
     }
-
-    // 2. CPU Clock: Read from sysfs scaling driver (Live data)
-    QFile freqFile("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq");
-    if (freqFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        cpuFreqGhz = freqFile.readAll().trimmed().toDouble() / 1000000.0;
-    }
-
-    // 3. CPU Temp: Search hwmon for real silicon sensors
-    QDir hwmonDir("/sys/class/hwmon");
-    QStringList hwmons = hwmonDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    for (const QString &dir : hwmons) {
-        QString path = "/sys/class/hwmon/" + dir;
-        QFile nameFile(path + "/name");
-        if (nameFile.open(QIODevice::ReadOnly)) {
-            QString name = nameFile.readAll().trimmed();
-            // Check for common CPU thermal drivers
-            if (name == "coretemp" || name == "k10temp" || name == "cpu_thermal" || name == "soc_thermal") {
-                QFile tempFile(path + "/temp1_input");
-                if (tempFile.open(QIODevice::ReadOnly)) {
-                    cpuTemp = tempFile.readAll().trimmed().toDouble() / 1000.0;
-                    if (cpuTemp > 0) break;
-                }
+    if (!m_paused) {
+        for (const ResourcesConsumer *consumer : std::as_const(m_consumers)) {
+            if (!consumer->active()) continue;
+            for (const QString &name : consumer->groups()) {
+                const int group = groupIndex(name);
+                if (group < 0) continue;
+                const int interval = consumer->interval() > 0
+                    ? qMax(consumer->interval(), kMinIntervalMs)
+                    : kDefaultIntervalsMs[group];
+                intervals[group] = intervals[group] == 0 ? interval : qMin(intervals[group], interval);
             }
         }
     }
+
+    if (intervals == m_intervals) return;
+    m_intervals = intervals;
+    QMetaObject::invokeMethod(m_sampler, "setSchedule", Q_ARG(QList<int>, intervals));
+}
+
+void ResourcesService::setPercentEpsilon(qreal epsilon)
+{
+    if (qFuzzyCompare(m_percentEpsilon, epsilon)) return;
+    m_percentEpsilon = epsilon;
+    m_cores->setEpsilons(float(m_percentEpsilon), float(m_frequencyEpsilon));
+    updateProcessEpsilons();
+    emit epsilonsChanged();
+}
+
+void ResourcesService::setFrequencyEpsilon(qreal epsilon)
+{
+    if (qFuzzyCompare(m_frequencyEpsilon, epsilon)) return;
+    m_frequencyEpsilon = epsilon;
+    m_cores->setEpsilons(float(m_percentEpsilon), float(m_frequencyEpsilon));
+    emit epsilonsChanged();
+}
+
+void ResourcesService::setDiskExclude(const QStringList &globs)
+{
+    if (m_diskExclude == globs) return;
+    m_diskExclude = globs;
+    QMetaObject::invokeMethod(m_sampler, "setDiskExclude", Q_ARG(QStringList, globs));
+    emit diskExcludeChanged();
+}
+
+void ResourcesService::setNetworkExclude(const QStringList &globs)
+{
+    if (m_networkExclude == globs) return;
+    m_networkExclude = globs;
+    QMetaObject::invokeMethod(m_sampler, "setNetworkExclude", Q_ARG(QStringList, globs));
+    emit networkExcludeChanged();
 }
 
-void ResourcesService::readMemoryAndSwapStats(quint64 &memTotal, quint64 &memAvailable, quint64 &swapTotal, quint64 &swapFree)
+void ResourcesService::setTemperatureEpsilon(qreal epsilon)
 {
-    struct sysinfo info;
-    if (sysinfo(&info) == 0) {
-        quint64 unit = info.mem_unit;
+    if (qFuzzyCompare(m_temperatureEpsilon, epsilon)) return;
+    m_temperatureEpsilon = epsilon;
+    emit epsilonsChanged();
+}
 
-        memTotal = static_cast<quint64>(info.totalram) * unit;
-        memAvailable = static_cast<quint64>(info.freeram + info.bufferram) * unit;
+void ResourcesService::setMemoryEpsilon(qint64 epsilon)
+{
+    if (m_memoryEpsilon == epsilon) return;
+    m_memoryEpsilon = epsilon;
+    updateProcessEpsilons();
+    emit epsilonsChanged();
+}
+
+void ResourcesService::updateProcessEpsilons()
+{
+    const quint64 bytes = quint64(qMax<qint64>(m_memoryEpsilon, 0));
+    m_topCpu->setEpsilons(float(m_percentEpsilon), bytes);
+    m_topMemory->setEpsilons(float(m_percentEpsilon), bytes);
+}
+
+void ResourcesService::setRateEpsilon(qint64 epsilon)
+{
+    if (m_rateEpsilon == epsilon) return;
+    m_rateEpsilon = epsilon;
+    emit epsilonsChanged();
+}
 
-        swapTotal = static_cast<quint64>(info.totalswap) * unit;
-        swapFree = static_cast<quint64>(info.freeswap) * unit;
-    } else {
-        qDebug() << "Failed to get sysinfo stats";
+void ResourcesService::onSampled(const QVariantMap &stats, const CpuSample &cpu, int groups)
+{
+    if (groups & ResourcesSampler::groupBit(ResourcesSampler::Cpu)) {
+        m_cores->update(cpu);
     }
+    recordHistory(stats, cpu, groups);
+    if (publishStats(stats, cpu, groups)) emit statsChanged();
 }
 
-QVariantList ResourcesService::readGpuStats()
+bool ResourcesService::publishStats(const QVariantMap &stats, const CpuSample &cpu, int groups)
 {
-    QVariantList gpus;
-    QProcess process;
+    auto ran = [groups](ResourcesSampler::Group group) {
+        return (groups & ResourcesSampler::groupBit(group)) != 0;
+    };
+    bool changed = false;
 
-    // Updated query to include power usage and limits
-    QStringList arguments;
-    arguments << "--query-gpu=name,temperature.gpu,utilization.gpu,memory.total,memory.used,power.draw,power.limit"
-              << "--format=csv,noheader,nounits";
+    if (ran(ResourcesSampler::Cpu)) {
+        changed |= publish(m_cpuPercent, stats.value("cpu_percent").toReal(), m_percentEpsilon,
+                           &ResourcesService::cpuPercentChanged);
+        changed |= publish(m_cpuFreqGhz, stats.value("cpu_freq_ghz").toReal(), m_frequencyEpsilon,
+                           &ResourcesService::cpuFreqGhzChanged);
+    }
 
-    process.start("nvidia-smi", arguments);
-    if (!process.waitForFinished(500)) return gpus;
+    if (ran(ResourcesSampler::Thermal)) {
+        changed |= publish(m_cpuTemp, stats.value("cpu_temp").toReal(), m_temperatureEpsilon,
+                           &ResourcesService::cpuTempChanged);
 
-    QString output = QString::fromLocal8Bit(process.readAllStandardOutput());
-    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+        bool tempsMoved = cpu.packageTemps.size() != m_packageTemps.size();
+        for (int i = 0; !tempsMoved && i < m_packageTemps.size(); ++i) {
+            tempsMoved = movedPast(m_packageTemps[i], cpu.packageTemps[i], m_temperatureEpsilon);
+        }
+        if (tempsMoved) {
+            m_packageTemps = cpu.packageTemps;
+            emit packageTempsChanged();
+        }
+    }
 
-    for (int i = 0; i < lines.size(); ++i) {
-        QStringList fields = lines[i].split(',');
-        if (fields.size() >= 7) {
-            QVariantMap gpu;
-            gpu["index"] = i;
-            gpu["name"] = fields[0].trimmed();
-            gpu["temperature"] = fields[1].trimmed().toDouble();
-            gpu["utilization"] = fields[2].trimmed().toDouble();
-            // QML expects MB for the display text you wrote
-            gpu["memory_total"] = fields[3].trimmed().toDouble();
-            gpu["memory_used"] = fields[4].trimmed().toDouble();
-            gpu["power_draw"] = fields[5].trimmed().toDouble();
-            gpu["power_limit"] = fields[6].trimmed().toDouble();
+    if (ran(ResourcesSampler::Memory)) {
+        changed |= publish(m_memTotal, stats.value("mem_total").toLongLong(), m_memoryEpsilon,
+                           &ResourcesService::memTotalChanged);
+        changed |= publish(m_memAvailable, stats.value("mem_available").toLongLong(), m_memoryEpsilon,
+                           &ResourcesService::memAvailableChanged);
+        changed |= publish(m_swapTotal, stats.value("swap_total").toLongLong(), m_memoryEpsilon,
+                           &ResourcesService::swapTotalChanged);
+        changed |= publish(m_swapFree, stats.value("swap_free").toLongLong(), m_memoryEpsilon,
+                           &ResourcesService::swapFreeChanged);
+        changed |= publish(m_memCached, stats.value("mem_cached").toLongLong(), m_memoryEpsilon,
+                           &ResourcesService::memCachedChanged);
+        changed |= publish(m_memDirty, stats.value("mem_dirty").toLongLong(), m_memoryEpsilon,
+                           &ResourcesService::memDirtyChanged);
+    }
 
-            gpus.append(gpu);
+    const double rateEpsilon = double(m_rateEpsilon);
+    if (ran(ResourcesSampler::Disk)) {
+        const QVariantList disks = stats.value("disks").toList();
+        if (listMoved(m_disks, disks, {"name"},
+                      {{"read", rateEpsilon}, {"write", rateEpsilon}, {"busy", m_percentEpsilon}})) {
+            m_disks = disks;
+            m_stats["disks"] = m_disks;
+            emit disksChanged();
+            changed = true;
         }
     }
-    return gpus;
+    if (ran(ResourcesSampler::Network)) {
+        const QVariantList network = stats.value("network").toList();
+        if (listMoved(m_network, network, {"name"}, {{"rx", rateEpsilon}, {"tx", rateEpsilon}})) {
+            m_network = network;
+            m_stats["network"] = m_network;
+            emit networkChanged();
+            changed = true;
+        }
+    }
+    if (ran(ResourcesSampler::Pressure)) {
+        const QVariantMap pressure = stats.value("pressure").toMap();
+        bool moved = pressure.keys() != m_pressure.keys();
+        for (auto it = pressure.cbegin(); !moved && it != pressure.cend(); ++it) {
+            moved = readingsMoved(m_pressure.value(it.key()).toMap(), it.value().toMap(),
+                                  {{"some10", m_percentEpsilon}, {"some60", m_percentEpsilon},
+                                   {"some300", m_percentEpsilon}, {"full10", m_percentEpsilon},
+                                   {"full60", m_percentEpsilon}, {"full300", m_percentEpsilon}});
+        }
+        if (moved) {
+            m_pressure = pressure;
+            m_stats["pressure"] = m_pressure;
+            emit pressureChanged();
+            changed = true;
+        }
+    }
+
+    if (ran(ResourcesSampler::Gpu)) {
+        const QVariantList gpus = stats.value("gpus").toList();
+        if (gpusMoved(gpus)) {
+            m_gpus = gpus;
+            m_stats["gpus"] = m_gpus;
+            emit gpusChanged();
+            changed = true;
+        }
+    }
+    if (ran(ResourcesSampler::GpuClients)) {
+        const QVariantList clients = stats.value("gpu_clients").toList();
+        if (listMoved(m_gpuClients, clients, {"pid", "driver"},
+                      {{"busy", m_percentEpsilon}, {"vram", double(m_memoryEpsilon)}})) {
+            m_gpuClients = clients;
+            m_stats["gpu_clients"] = m_gpuClients;
+            emit gpuClientsChanged();
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        // The legacy map mirrors the published values, not the raw ones.
+        m_stats["cpu_percent"] = cpuPercent();
+        m_stats["cpu_freq_ghz"] = cpuFreqGhz();
+        m_stats["cpu_temp"] = cpuTemp();
+        m_stats["mem_total"] = memTotal();
+        m_stats["mem_available"] = memAvailable();
+        m_stats["swap_total"] = swapTotal();
+        m_stats["swap_free"] = swapFree();
+        m_stats["mem_cached"] = memCached();
+        m_stats["mem_dirty"] = memDirty();
+    }
+    return changed;
+}
+
+bool ResourcesService::gpusMoved(const QVariantList &next) const
+{
+    if (next.size() != m_gpus.size()) return true;
+
+    // GPUs are matched by position; "index" is assigned in order.
+    const double memoryEpsilonMb = double(m_memoryEpsilon) / (1024 * 1024);
+    for (int i = 0; i < next.size(); ++i) {
+        const QVariantMap published = m_gpus[i].toMap();
+        const QVariantMap gpu = next[i].toMap();
+        if (published.value("name") != gpu.value("name") || published.value("backend") != gpu.value("backend")) {
+            return true;
+        }
+        if (readingsMoved(published, gpu,
+                          {{"utilization", m_percentEpsilon},
+                           {"temperature", m_temperatureEpsilon},
+                           {"memory_used", memoryEpsilonMb},
+                           {"memory_total", memoryEpsilonMb},
+                           {"power_draw", kPowerEpsilonW},
+                           {"power_limit", kPowerEpsilonW},
+                           {"frequency_mhz", m_frequencyEpsilon * 1000.0}})) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ResourcesService::recordHistory(const QVariantMap &stats, const CpuSample &cpu, int groups)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    auto ran = [groups](ResourcesSampler::Group group) {
+        return (groups & ResourcesSampler::groupBit(group)) != 0;
+    };
+
+    if (ran(ResourcesSampler::Cpu)) {
+        m_history->append("cpu", now, cpu.totalUsage);
+    }
+    if (ran(ResourcesSampler::Thermal)) {
+        m_history->append("cpu_temp", now, stats.value("cpu_temp").toFloat());
+    }
+
+    const double memTotal = stats.value("mem_total").toDouble();
+    if (ran(ResourcesSampler::Memory) && memTotal > 0) {
+        const double used = memTotal - stats.value("mem_available").toDouble();
+        m_history->append("mem", now, float(100.0 * used / memTotal));
+    }
+    const double swapTotal = stats.value("swap_total").toDouble();
+    if (ran(ResourcesSampler::Memory) && swapTotal > 0) {
+        const double used = swapTotal - stats.value("swap_free").toDouble();
+        m_history->append("swap", now, float(100.0 * used / swapTotal));
+    }
+
+    const QVariantList gpus = ran(ResourcesSampler::Gpu) ? stats.value("gpus").toList() : QVariantList();
+    for (int i = 0; i < gpus.size(); ++i) {
+        const QVariantMap gpu = gpus[i].toMap();
+        if (gpu.isEmpty()) continue;
+        m_history->append(QStringLiteral("gpu%1").arg(i), now, gpu.value("utilization").toFloat());
+    }
+
+    auto sumOf = [](const QVariantList &devices, const char *key) {
+        double total = 0.0;
+        for (const QVariant &device : devices) total += device.toMap().value(key).toDouble();
+        return float(total);
+    };
+    if (ran(ResourcesSampler::Disk)) {
+        const QVariantList disks = stats.value("disks").toList();
+        m_history->append("disk_read", now, sumOf(disks, "read"));
+        m_history->append("disk_write", now, sumOf(disks, "write"));
+    }
+    if (ran(ResourcesSampler::Network)) {
+        const QVariantList links = stats.value("network").toList();
+        m_history->append("net_rx", now, sumOf(links, "rx"));
+        m_history->append("net_tx", now, sumOf(links, "tx"));
+    }
+    if (ran(ResourcesSampler::Pressure)) {
+        const QVariantMap pressure = stats.value("pressure").toMap();
+        for (auto it = pressure.cbegin(); it != pressure.cend(); ++it) {
+            m_history->append("psi_" + it.key(), now, it.value().toMap().value("some10").toFloat());
+        }
+    }
+
+    m_history->commit();
+}
+
+void ResourcesService::onProcessesSampled(const ProcessSample &processes)
+{
+    m_topCpu->update(processes.topCpu);
+    m_topMemory->update(processes.topMemory);
+    if (m_processCount != processes.processCount) {
+        m_processCount = processes.processCount;
+        emit processCountChanged();
+    }
+}
+
+QStringList ResourcesService::findSensors(const QString &label, const QString &kind) const
+{
+    QStringList ids;
+    for (const QVariant &entry : m_sensors) {
+        const QVariantMap sensor = entry.toMap();
+        if (!kind.isEmpty() && sensor.value("kind").toString() != kind) continue;
+        if (sensor.value("label").toString().contains(label, Qt::CaseInsensitive)
+            || sensor.value("id").toString().contains(label, Qt::CaseInsensitive)) {
+            ids.append(sensor.value("id").toString());
+        }
+    }
+    return ids;
+}
+
+void ResourcesService::watchSensor(const QString &id)
+{
+    if (m_sensorWatchers[id]++ == 0) updateWatchedSensors();
+}
+
+void ResourcesService::unwatchSensor(const QString &id)
+{
+    auto it = m_sensorWatchers.find(id);
+    if (it == m_sensorWatchers.end()) return;
+    if (--it.value() == 0) {
+        m_sensorWatchers.erase(it);
+        updateWatchedSensors();
+    }
+}
+
+void ResourcesService::updateWatchedSensors()
+{
+    QMetaObject::invokeMethod(m_sampler, "setWatchedSensors",
+                              Q_ARG(QStringList, m_sensorWatchers.keys()));
+}
+
+void ResourcesService::onSensorsDiscovered(const QVariantList &sensors)
+{
+    if (m_sensors == sensors) return;
+    m_sensors = sensors;
+    m_sensorKinds.clear();
+    for (const QVariant &sensor : sensors) {
+        const QVariantMap map = sensor.toMap();
+        m_sensorKinds.insert(map.value("id").toString(), map.value("kind").toString());
+    }
+    emit sensorsChanged();
+}
+
+double ResourcesService::sensorEpsilon(const QString &id) const
+{
+    const QString kind = m_sensorKinds.value(id);
+    if (kind == QLatin1String("fan")) return kFanEpsilonRpm;
+    if (kind == QLatin1String("power")) return kPowerEpsilonW;
+    if (kind == QLatin1String("voltage")) return kVoltageEpsilonV;
+    if (kind == QLatin1String("current")) return kCurrentEpsilonA;
+    return m_temperatureEpsilon;
+}
+
+void ResourcesService::onSensorsSampled(const QVariantMap &values)
+{
+    bool moved = values.keys() != m_sensorValues.keys();
+    for (auto it = values.cbegin(); !moved && it != values.cend(); ++it) {
+        moved = movedPast(m_sensorValues.value(it.key()).toDouble(), it.value().toDouble(),
+                          sensorEpsilon(it.key()));
+    }
+    if (!moved) return;
+
+    m_sensorValues = values;
+    emit sensorValuesChanged();
 }
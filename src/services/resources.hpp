@@ -4,8 +4,19 @@
 #include <QObject>
 #include <QVariantMap>
 #include <QVariantList>
-#include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
 #include <qqmlengine.h>
+#include "resources_cpu_model.hpp"
+#include "resources_damped.hpp"
+#include "resources_history.hpp"
+#include "resources_process_model.hpp"
+
+class ResourcesSampler;
+class ResourcesConsumer;
 
 class ResourcesService : public QObject
 {
@@ -13,32 +24,209 @@ class ResourcesService : public QObject
     QML_ELEMENT
     QML_SINGLETON
     Q_PROPERTY(QVariantMap stats READ stats NOTIFY statsChanged)
+    Q_PROPERTY(qreal cpuPercent READ cpuPercent NOTIFY cpuPercentChanged)
+    Q_PROPERTY(qreal cpuFreqGhz READ cpuFreqGhz NOTIFY cpuFreqGhzChanged)
+    Q_PROPERTY(qreal cpuTemp READ cpuTemp NOTIFY cpuTempChanged)
+    Q_PROPERTY(qint64 memTotal READ memTotal NOTIFY memTotalChanged)
+    Q_PROPERTY(qint64 memAvailable READ memAvailable NOTIFY memAvailableChanged)
+    Q_PROPERTY(qint64 swapTotal READ swapTotal NOTIFY swapTotalChanged)
+    Q_PROPERTY(qint64 swapFree READ swapFree NOTIFY swapFreeChanged)
+    Q_PROPERTY(qint64 memCached READ memCached NOTIFY memCachedChanged)
+    Q_PROPERTY(qint64 memDirty READ memDirty NOTIFY memDirtyChanged)
+    Q_PROPERTY(QVariantList disks READ disks NOTIFY disksChanged)
+    Q_PROPERTY(QVariantList network READ network NOTIFY networkChanged)
+    Q_PROPERTY(QVariantMap pressure READ pressure NOTIFY pressureChanged)
+    Q_PROPERTY(QVariantList gpus READ gpus NOTIFY gpusChanged)
+    Q_PROPERTY(QVariantList gpuClients READ gpuClients NOTIFY gpuClientsChanged)
+    Q_PROPERTY(QStringList diskExclude READ diskExclude WRITE setDiskExclude NOTIFY diskExcludeChanged)
+    Q_PROPERTY(QStringList networkExclude READ networkExclude WRITE setNetworkExclude NOTIFY networkExcludeChanged)
+    Q_PROPERTY(qreal percentEpsilon READ percentEpsilon WRITE setPercentEpsilon NOTIFY epsilonsChanged)
+    Q_PROPERTY(qreal frequencyEpsilon READ frequencyEpsilon WRITE setFrequencyEpsilon NOTIFY epsilonsChanged)
+    Q_PROPERTY(qreal temperatureEpsilon READ temperatureEpsilon WRITE setTemperatureEpsilon NOTIFY epsilonsChanged)
+    Q_PROPERTY(qint64 memoryEpsilon READ memoryEpsilon WRITE setMemoryEpsilon NOTIFY epsilonsChanged)
+    Q_PROPERTY(qint64 rateEpsilon READ rateEpsilon WRITE setRateEpsilon NOTIFY epsilonsChanged)
+    Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
+    Q_PROPERTY(CpuCoreModel* cores READ cores CONSTANT)
+    Q_PROPERTY(QList<qreal> packageTemps READ packageTemps NOTIFY packageTempsChanged)
+    Q_PROPERTY(ResourcesHistory* history READ history CONSTANT)
+    Q_PROPERTY(ProcessListModel* topCpu READ topCpu CONSTANT)
+    Q_PROPERTY(ProcessListModel* topMemory READ topMemory CONSTANT)
+    Q_PROPERTY(int processCount READ processCount NOTIFY processCountChanged)
+    Q_PROPERTY(QVariantList sensors READ sensors NOTIFY sensorsChanged)
+    Q_PROPERTY(QVariantMap sensorValues READ sensorValues NOTIFY sensorValuesChanged)
 
 public:
     static ResourcesService* instance();
     static ResourcesService* create(QQmlEngine *qmlEngine, QJSEngine *jsEngine);
+    // Kept for older bindings; prefer the typed properties below, which only
+    // notify when their own value moves past its epsilon.
     QVariantMap stats() const { return m_stats; }
 
+    qreal cpuPercent() const { return m_cpuPercent.value(); }
+    qreal cpuFreqGhz() const { return m_cpuFreqGhz.value(); }
+    qreal cpuTemp() const { return m_cpuTemp.value(); }
+    qint64 memTotal() const { return m_memTotal.value(); }
+    qint64 memAvailable() const { return m_memAvailable.value(); }
+    qint64 swapTotal() const { return m_swapTotal.value(); }
+    qint64 swapFree() const { return m_swapFree.value(); }
+    qint64 memCached() const { return m_memCached.value(); }
+    qint64 memDirty() const { return m_memDirty.value(); }
+
+    // {name, read, write, busy} per disk and {name, rx, tx} per interface,
+    // in bytes per second; pressure maps "cpu", "memory" and "io" to their
+    // PSI averages.
+    QVariantList disks() const { return m_disks; }
+    QVariantList network() const { return m_network; }
+    QVariantMap pressure() const { return m_pressure; }
+
+    // One map per GPU with the keys listed in resources_gpu.hpp. Republished
+    // when a card appears or goes away, or when one of its readings moves
+    // past the matching epsilon.
+    QVariantList gpus() const { return m_gpus; }
+
+    // Processes using a GPU through DRM, busiest first:
+    // {pid, name, driver, busy (%), vram (bytes)}. Needs the "gpu_clients"
+    // group.
+    QVariantList gpuClients() const { return m_gpuClients; }
+
+    // Glob patterns of device names to leave out.
+    QStringList diskExclude() const { return m_diskExclude; }
+    void setDiskExclude(const QStringList &globs);
+    QStringList networkExclude() const { return m_networkExclude; }
+    void setNetworkExclude(const QStringList &globs);
+
+    // Minimum change (since the last notification) before a value is
+    // republished. Percentages, GHz, degrees Celsius, bytes and bytes per
+    // second (disk and network throughput) respectively. Busy and PSI
+    // values use the percentage epsilon.
+    qreal percentEpsilon() const { return m_percentEpsilon; }
+    void setPercentEpsilon(qreal epsilon);
+    qreal frequencyEpsilon() const { return m_frequencyEpsilon; }
+    void setFrequencyEpsilon(qreal epsilon);
+    qreal temperatureEpsilon() const { return m_temperatureEpsilon; }
+    void setTemperatureEpsilon(qreal epsilon);
+    qint64 memoryEpsilon() const { return m_memoryEpsilon; }
+    void setMemoryEpsilon(qint64 epsilon);
+    qint64 rateEpsilon() const { return m_rateEpsilon; }
+    void setRateEpsilon(qint64 epsilon);
+
+    // Stops all sampling while set, without consumers having to
+    // unsubscribe. The service does not detect anything itself; the shell
+    // sets this, e.g. from its lock screen or panel visibility.
+    bool paused() const { return m_paused; }
+    void setPaused(bool paused);
+    CpuCoreModel* cores() const { return m_cores; }
+    QList<qreal> packageTemps() const { return m_packageTemps; }
+    ResourcesHistory* history() const { return m_history; }
+    ProcessListModel* topCpu() const { return m_topCpu; }
+    ProcessListModel* topMemory() const { return m_topMemory; }
+    int processCount() const { return m_processCount; }
+
+    QVariantList sensors() const { return m_sensors; }
+    QVariantMap sensorValues() const { return m_sensorValues; }
+
+    // Ids of the sensors whose label (or id) contains `label`, optionally
+    // restricted to one kind ("temperature", "fan", "power", ...).
+    Q_INVOKABLE QStringList findSensors(const QString &label, const QString &kind = QString()) const;
+    // Only watched sensors are read and reported in sensorValues, which
+    // notifies once a reading moves past the epsilon for its kind
+    // (temperatureEpsilon for temperatures).
+    Q_INVOKABLE void watchSensor(const QString &id);
+    Q_INVOKABLE void unwatchSensor(const QString &id);
+
+    void updateConsumer(ResourcesConsumer *consumer);
+    void removeConsumer(ResourcesConsumer *consumer);
+
 signals:
     void statsChanged();
+    void cpuPercentChanged();
+    void cpuFreqGhzChanged();
+    void cpuTempChanged();
+    void memTotalChanged();
+    void memAvailableChanged();
+    void swapTotalChanged();
+    void swapFreeChanged();
+    void memCachedChanged();
+    void memDirtyChanged();
+    void disksChanged();
+    void networkChanged();
+    void pressureChanged();
+    void gpusChanged();
+    void gpuClientsChanged();
+    void diskExcludeChanged();
+    void networkExcludeChanged();
+    void epsilonsChanged();
+    void pausedChanged();
+    void packageTempsChanged();
+    void processCountChanged();
+    void sensorsChanged();
+    void sensorValuesChanged();
 
 private:
     explicit ResourcesService(QObject *parent = nullptr);
-    ~ResourcesService() override = default;
+    ~ResourcesService() override;
 
     ResourcesService(const ResourcesService&) = delete;
     ResourcesService& operator=(const ResourcesService&) = delete;
 
-    void updateStats();
-    void readCpuStats(double &cpuPercent, double &cpuFreqGhz, double &cpuTemp);
-    // This is the line that needs to match the .cpp
-    void readMemoryAndSwapStats(quint64 &memTotal, quint64 &memAvailable, quint64 &swapTotal, quint64 &swapFree);
-    QVariantList readGpuStats();
+    void onSampled(const QVariantMap &stats, const CpuSample &cpu, int groups);
+    void recordHistory(const QVariantMap &stats, const CpuSample &cpu, int groups);
+    void reschedule();
+    bool publishStats(const QVariantMap &stats, const CpuSample &cpu, int groups);
+    bool gpusMoved(const QVariantList &next) const;
+
+    template <typename T>
+    bool publish(DampedValue<T> &value, T next, T epsilon, void (ResourcesService::*notify)())
+    {
+        if (!value.update(next, epsilon)) return false;
+        emit (this->*notify)();
+        return true;
+    }
+    void onProcessesSampled(const ProcessSample &processes);
+    void onSensorsDiscovered(const QVariantList &sensors);
+    void onSensorsSampled(const QVariantMap &values);
+    double sensorEpsilon(const QString &id) const;
+    void updateProcessEpsilons();
+    void updateWatchedSensors();
 
     QVariantMap m_stats;
-    QTimer *m_updateTimer;
-    quint64 m_prevTotal;
-    quint64 m_prevIdle;
+    DampedValue<qreal> m_cpuPercent;
+    DampedValue<qreal> m_cpuFreqGhz;
+    DampedValue<qreal> m_cpuTemp;
+    DampedValue<qint64> m_memTotal;
+    DampedValue<qint64> m_memAvailable;
+    DampedValue<qint64> m_swapTotal;
+    DampedValue<qint64> m_swapFree;
+    DampedValue<qint64> m_memCached;
+    DampedValue<qint64> m_memDirty;
+    QVariantList m_disks;
+    QVariantList m_network;
+    QVariantMap m_pressure;
+    QVariantList m_gpus;
+    QVariantList m_gpuClients;
+    QStringList m_diskExclude = {"loop*", "ram*", "zram*", "dm-*"};
+    QStringList m_networkExclude = {"lo", "veth*", "docker*", "br-*", "virbr*"};
+    QList<qreal> m_packageTemps;
+    qreal m_percentEpsilon = 0.5;
+    qreal m_frequencyEpsilon = 0.05;
+    qreal m_temperatureEpsilon = 0.5;
+    qint64 m_memoryEpsilon = 1024 * 1024;
+    qint64 m_rateEpsilon = 64 * 1024;
+    CpuCoreModel *m_cores;
+    ResourcesHistory *m_history;
+    ProcessListModel *m_topCpu;
+    ProcessListModel *m_topMemory;
+    int m_processCount = 0;
+    QSet<ResourcesConsumer*> m_consumers;
+    QList<int> m_intervals;
+    bool m_paused = false;
+    bool m_consumerSeen = false;
+    QVariantList m_sensors;
+    QVariantMap m_sensorValues;
+    QHash<QString, QString> m_sensorKinds;
+    QHash<QString, int> m_sensorWatchers;
+    QThread *m_thread;
+    ResourcesSampler *m_sampler;
     static ResourcesService *s_instance;
 };
 
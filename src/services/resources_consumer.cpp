@@ -0,0 +1,43 @@
+#include "resources_consumer.hpp"
+#include "resources.hpp"
+
+ResourcesConsumer::ResourcesConsumer(QObject* parent)
+    : QObject(parent)
+{
+}
+
+ResourcesConsumer::~ResourcesConsumer() {
+    if (m_complete) ResourcesService::instance()->removeConsumer(this);
+}
+
+void ResourcesConsumer::setGroups(const QStringList& groups) {
+    if (m_groups == groups) return;
+    m_groups = groups;
+    changed();
+    emit groupsChanged();
+}
+
+void ResourcesConsumer::setInterval(int interval) {
+    if (m_interval == interval) return;
+    m_interval = interval;
+    changed();
+    emit intervalChanged();
+}
+
+void ResourcesConsumer::setActive(bool active) {
+    if (m_active == active) return;
+    m_active = active;
+    changed();
+    emit activeChanged();
+}
+
+void ResourcesConsumer::componentComplete() {
+    m_complete = true;
+    changed();
+}
+
+void ResourcesConsumer::changed() {
+    // Wait for the initial bindings so a consumer registers once, with its
+    // final settings.
+    if (m_complete) ResourcesService::instance()->updateConsumer(this);
+}
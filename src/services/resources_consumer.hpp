@@ -0,0 +1,49 @@
+#pragma once
+#include <QObject>
+#include <QQmlParserStatus>
+#include <QStringList>
+#include <qqml.h>
+
+// Declares that a piece of UI needs some ResourcesService metric groups
+// ("cpu", "memory", "thermal", "gpu", "processes", "disk", "network",
+// "pressure", "gpu_clients"). The service samples a group only while an
+// active consumer asks for it, at the shortest interval any of them
+// requests. Bind `active` to the widget's visibility. Until the first
+// consumer registers, the service keeps sampling cpu, memory, thermal and
+// gpu at their default intervals, so existing QML keeps working unchanged.
+class ResourcesConsumer : public QObject, public QQmlParserStatus {
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+    QML_ELEMENT
+    Q_PROPERTY(QStringList groups READ groups WRITE setGroups NOTIFY groupsChanged)
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+
+public:
+    explicit ResourcesConsumer(QObject* parent = nullptr);
+    ~ResourcesConsumer() override;
+
+    QStringList groups() const { return m_groups; }
+    void setGroups(const QStringList& groups);
+    // 0 uses the group's default interval.
+    int interval() const { return m_interval; }
+    void setInterval(int interval);
+    bool active() const { return m_active; }
+    void setActive(bool active);
+
+    void classBegin() override {}
+    void componentComplete() override;
+
+signals:
+    void groupsChanged();
+    void intervalChanged();
+    void activeChanged();
+
+private:
+    void changed();
+
+    QStringList m_groups;
+    int m_interval = 0;
+    bool m_active = true;
+    bool m_complete = false;
+};
@@ -0,0 +1,140 @@
+#include "resources_cpu.hpp"
+
+namespace {
+// Large enough for the cpu lines of a few hundred cores; the tail of
+// /proc/stat (intr, ctxt, ...) is not needed.
+constexpr int kStatCapacity = 64 * 1024;
+
+quint64 delta(quint64 next, quint64 prev)
+{
+    // Counters restart when a core is hot-plugged.
+    return next > prev ? next - prev : 0;
+}
+}
+
+CpuCollector::CpuCollector(const SysRoot &root)
+    : m_root(root)
+{
+    m_stat.open(m_root.path("/proc/stat"), kStatCapacity);
+}
+
+bool CpuCollector::parseCounters(SysParser &parser, Counters &counters)
+{
+    // user nice system idle iowait irq softirq steal; guest time is already
+    // included in user and nice.
+    quint64 f[8] = {};
+    int count = 0;
+    while (count < 8 && parser.uint64(f[count])) ++count;
+    if (count < 4) return false;
+
+    counters.user = f[0] + f[1];
+    counters.system = f[2];
+    counters.idle = f[3];
+    counters.iowait = f[4];
+    counters.irq = f[5] + f[6];
+    counters.steal = f[7];
+    counters.total = counters.user + counters.system + counters.idle
+                     + counters.iowait + counters.irq + counters.steal;
+    return true;
+}
+
+CpuCollector::Shares CpuCollector::shares(const Counters &prev, const Counters &next)
+{
+    Shares s;
+    if (prev.total == 0) return s;
+
+    const quint64 total = delta(next.total, prev.total);
+    if (total == 0) return s;
+
+    const float scale = 100.0f / float(total);
+    s.user = float(delta(next.user, prev.user)) * scale;
+    s.system = float(delta(next.system, prev.system)) * scale;
+    s.iowait = float(delta(next.iowait, prev.iowait)) * scale;
+    s.irq = float(delta(next.irq, prev.irq)) * scale;
+    s.steal = float(delta(next.steal, prev.steal)) * scale;
+    // Waiting on I/O is idle time as far as the CPU is concerned.
+    s.usage = s.user + s.system + s.irq + s.steal;
+    return s;
+}
+
+void CpuCollector::resizeCores(int count)
+{
+    m_coreIds.resize(count, -1);
+    m_prev.resize(count);
+    m_freq.resize(count);
+}
+
+bool CpuCollector::collect(CpuSample &sample)
+{
+    if (!m_stat.read()) return false;
+
+    SysParser parser(m_stat);
+    int row = 0;
+    while (!parser.atEnd() && parser.startsWith("cpu", 3)) {
+        parser.skip(3);
+        const bool aggregate = parser.startsWith(" ", 1);
+        quint64 id = 0;
+        Counters counters;
+        if ((!aggregate && !parser.uint64(id)) || !parseCounters(parser, counters)) {
+            parser.nextLine();
+            continue;
+        }
+        parser.nextLine();
+
+        if (aggregate) {
+            const Shares s = shares(m_prevTotal, counters);
+            sample.totalUsage = s.usage;
+            sample.totalIowait = s.iowait;
+            m_prevTotal = counters;
+            continue;
+        }
+
+        if (row >= int(m_coreIds.size())) resizeCores(row + 1);
+        if (m_coreIds[row] != int(id)) {
+            // A core went on- or offline; restart this row.
+            m_coreIds[row] = int(id);
+            m_prev[row] = Counters();
+            m_freq[row].open(m_root.path(QByteArrayLiteral("/sys/devices/system/cpu/cpu")
+                                         + QByteArray::number(id)
+                                         + QByteArrayLiteral("/cpufreq/scaling_cur_freq")), 64);
+        }
+
+        const Shares s = shares(m_prev[row], counters);
+        m_prev[row] = counters;
+
+        if (sample.coreIds.size() <= row) {
+            sample.coreIds.resize(row + 1);
+            sample.usage.resize(row + 1);
+            sample.user.resize(row + 1);
+            sample.system.resize(row + 1);
+            sample.iowait.resize(row + 1);
+            sample.irq.resize(row + 1);
+            sample.steal.resize(row + 1);
+            sample.frequencyGhz.resize(row + 1);
+        }
+        sample.coreIds[row] = int(id);
+        sample.usage[row] = s.usage;
+        sample.user[row] = s.user;
+        sample.system[row] = s.system;
+        sample.iowait[row] = s.iowait;
+        sample.irq[row] = s.irq;
+        sample.steal[row] = s.steal;
+
+        quint64 khz = 0;
+        sample.frequencyGhz[row] = m_freq[row].readUInt(khz) ? float(khz / 1000000.0) : 0.0f;
+        ++row;
+    }
+
+    if (row < int(m_coreIds.size())) resizeCores(row);
+    if (sample.coreIds.size() > row) {
+        sample.coreIds.resize(row);
+        sample.usage.resize(row);
+        sample.user.resize(row);
+        sample.system.resize(row);
+        sample.iowait.resize(row);
+        sample.irq.resize(row);
+        sample.steal.resize(row);
+        sample.frequencyGhz.resize(row);
+    }
+    return true;
+}
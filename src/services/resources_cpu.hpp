@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QList>
+#include <QMetaType>
+#include <vector>
+#include "resources_reader.hpp"
+
+// One tick of per-core CPU data, stored as flat parallel arrays indexed by
+// row (not by kernel cpu id, which can have holes when cores are offline).
+// Time shares are percentages of the last interval.
+struct CpuSample {
+    QList<int> coreIds;
+    QList<float> usage;
+    QList<float> user;
+    QList<float> system;
+    QList<float> iowait;
+    QList<float> irq;
+    QList<float> steal;
+    QList<float> frequencyGhz;
+    QList<qreal> packageTemps;
+
+    float totalUsage = 0.0f;
+    float totalIowait = 0.0f;
+
+    int coreCount() const { return coreIds.size(); }
+};
+Q_DECLARE_METATYPE(CpuSample)
+
+// Reads /proc/stat and the per-core cpufreq attributes through persistent
+// descriptors. Lives on the sampler thread; package temperatures are filled
+// in by SensorCollector.
+class CpuCollector
+{
+public:
+    explicit CpuCollector(const SysRoot &root);
+
+    // Fills sample with the shares since the previous call. The first call
+    // only primes the counters and reports zero usage.
+    bool collect(CpuSample &sample);
+
+private:
+    struct Counters {
+        quint64 user = 0;
+        quint64 system = 0;
+        quint64 idle = 0;
+        quint64 iowait = 0;
+        quint64 irq = 0;
+        quint64 steal = 0;
+        quint64 total = 0;
+    };
+
+    struct Shares {
+        float usage = 0.0f;
+        float user = 0.0f;
+        float system = 0.0f;
+        float iowait = 0.0f;
+        float irq = 0.0f;
+        float steal = 0.0f;
+    };
+
+    static bool parseCounters(SysParser &parser, Counters &counters);
+    static Shares shares(const Counters &prev, const Counters &next);
+    void resizeCores(int count);
+
+    SysRoot m_root;
+    SysFile m_stat;
+    Counters m_prevTotal;
+    std::vector<int> m_coreIds;
+    std::vector<Counters> m_prev;
+    std::vector<SysFile> m_freq;
+};
@@ -0,0 +1,100 @@
+#include "resources_cpu_model.hpp"
+#include "resources_damped.hpp"
+
+CpuCoreModel::CpuCoreModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int CpuCoreModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return m_sample.coreCount();
+}
+
+QVariant CpuCoreModel::data(const QModelIndex& index, int role) const {
+    const int row = index.row();
+    if (!index.isValid() || row < 0 || row >= m_sample.coreCount()) {
+        return {};
+    }
+
+    switch (role) {
+    case CoreRole:
+        return m_sample.coreIds[row];
+    case Qt::DisplayRole:
+    case UsageRole:
+        return m_sample.usage[row];
+    case UserRole:
+        return m_sample.user[row];
+    case SystemRole:
+        return m_sample.system[row];
+    case IowaitRole:
+        return m_sample.iowait[row];
+    case IrqRole:
+        return m_sample.irq[row];
+    case StealRole:
+        return m_sample.steal[row];
+    case FrequencyRole:
+        return m_sample.frequencyGhz[row];
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> CpuCoreModel::roleNames() const {
+    return {
+        {CoreRole, "core"},
+        {UsageRole, "usage"},
+        {UserRole, "user"},
+        {SystemRole, "system"},
+        {IowaitRole, "iowait"},
+        {IrqRole, "irq"},
+        {StealRole, "steal"},
+        {FrequencyRole, "frequency"}
+    };
+}
+
+void CpuCoreModel::setEpsilons(float percent, float frequencyGhz) {
+    m_percentEpsilon = percent;
+    m_frequencyEpsilon = frequencyGhz;
+}
+
+void CpuCoreModel::update(const CpuSample& sample) {
+    const int oldCount = m_sample.coreCount();
+    const int newCount = sample.coreCount();
+
+    if (oldCount != newCount || m_sample.coreIds != sample.coreIds) {
+        beginResetModel();
+        m_sample = sample;
+        endResetModel();
+        if (oldCount != newCount) emit countChanged();
+        return;
+    }
+
+    // Only values that moved far enough are taken over, so the stored sample
+    // is what QML last saw and the comparison has hysteresis.
+    auto apply = [](QList<float>& published, const QList<float>& next, int row, float epsilon) {
+        if (!movedPast(published[row], next[row], epsilon)) return false;
+        published[row] = next[row];
+        return true;
+    };
+
+    QList<int> roles;
+    for (int row = 0; row < newCount; ++row) {
+        roles.clear();
+        if (apply(m_sample.usage, sample.usage, row, m_percentEpsilon)) {
+            roles << Qt::DisplayRole << UsageRole;
+        }
+        if (apply(m_sample.user, sample.user, row, m_percentEpsilon)) roles << UserRole;
+        if (apply(m_sample.system, sample.system, row, m_percentEpsilon)) roles << SystemRole;
+        if (apply(m_sample.iowait, sample.iowait, row, m_percentEpsilon)) roles << IowaitRole;
+        if (apply(m_sample.irq, sample.irq, row, m_percentEpsilon)) roles << IrqRole;
+        if (apply(m_sample.steal, sample.steal, row, m_percentEpsilon)) roles << StealRole;
+        if (apply(m_sample.frequencyGhz, sample.frequencyGhz, row, m_frequencyEpsilon)) roles << FrequencyRole;
+        if (!roles.isEmpty()) {
+            emit dataChanged(index(row), index(row), roles);
+        }
+    }
+    m_sample.totalUsage = sample.totalUsage;
+    m_sample.totalIowait = sample.totalIowait;
+    m_sample.packageTemps = sample.packageTemps;
+}
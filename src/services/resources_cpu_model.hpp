@@ -0,0 +1,47 @@
+#pragma once
+#include <QAbstractListModel>
+#include <qqml.h>
+#include "resources_cpu.hpp"
+
+// One row per online core. A tick with an unchanged core set only emits
+// dataChanged for the cells that moved past the configured epsilons, so
+// delegates are kept and unchanged values cost no binding re-evaluation.
+class CpuCoreModel : public QAbstractListModel {
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("CpuCoreModel is provided by ResourcesService")
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        CoreRole = Qt::UserRole + 1,
+        UsageRole,
+        UserRole,
+        SystemRole,
+        IowaitRole,
+        IrqRole,
+        StealRole,
+        FrequencyRole
+    };
+    Q_ENUM(Roles)
+
+    explicit CpuCoreModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return m_sample.coreCount(); }
+    const CpuSample& sample() const { return m_sample; }
+
+    void update(const CpuSample& sample);
+    void setEpsilons(float percent, float frequencyGhz);
+
+signals:
+    void countChanged();
+
+private:
+    CpuSample m_sample;
+    float m_percentEpsilon = 0.0f;
+    float m_frequencyEpsilon = 0.0f;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <QtGlobal>
+
+// True when `next` differs from the last published value by at least
+// `epsilon`. Comparing against what was published (not the previous raw
+// sample) gives hysteresis: slow drift is still reported once it adds up,
+// while noise around one value is not.
+template <typename T>
+inline bool movedPast(T published, T next, T epsilon) {
+    if (next == published) return false;
+    const T delta = next > published ? next - published : published - next;
+    return delta >= epsilon;
+}
+
+// A published value plus the check above. The first update always
+// publishes.
+template <typename T>
+class DampedValue {
+public:
+    const T& value() const { return m_value; }
+
+    bool update(T next, T epsilon) {
+        if (m_set && !movedPast(m_value, next, epsilon)) return false;
+        m_value = next;
+        m_set = true;
+        return true;
+    }
+
+private:
+    T m_value{};
+    bool m_set = false;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QObject>
+#include <QVariantList>
+
+// One source of GPU stats. Backends live on the sampler thread and append
+// one map per GPU they know about, using the common keys:
+//
+//   name, vendor, backend, temperature (°C), utilization (%),
+//   memory_total / memory_used (MB), power_draw / power_limit (W),
+//   frequency_mhz
+//
+// Keys a backend cannot fill are left at 0. The sampler assigns "index"
+// across all backends.
+class GpuBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GpuBackend(QObject *parent = nullptr) : QObject(parent) {}
+
+    virtual void start(int intervalMs) { Q_UNUSED(intervalMs) }
+    virtual void stop() {}
+    virtual void collect(QVariantList &gpus) = 0;
+};
@@ -0,0 +1,240 @@
+#include "resources_gpu_clients.hpp"
+#include <QElapsedTimer>
+#include <QVariantMap>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+qint64 monotonicNs()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) clock.start();
+    return clock.nsecsElapsed();
+}
+
+bool startsWith(const char *begin, int length, const char *prefix)
+{
+    const int prefixLength = int(qstrlen(prefix));
+    return length >= prefixLength && qstrncmp(begin, prefix, prefixLength) == 0;
+}
+
+bool equals(const char *begin, int length, const char *key)
+{
+    return int(qstrlen(key)) == length && qstrncmp(begin, key, length) == 0;
+}
+
+int readAt(int dirFd, const char *path, char *buffer, int capacity)
+{
+    const int fd = ::openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n;
+    do {
+        n = ::pread(fd, buffer, size_t(capacity), 0);
+    } while (n < 0 && errno == EINTR);
+    ::close(fd);
+    return int(n);
+}
+}
+
+GpuClientCollector::GpuClientCollector(const SysRoot &root, int topCount)
+    : m_root(root)
+    , m_topCount(topCount)
+{
+}
+
+GpuClientCollector::~GpuClientCollector()
+{
+    if (m_procFd >= 0) ::close(m_procFd);
+}
+
+bool GpuClientCollector::openProc()
+{
+    if (m_procFd >= 0) return true;
+    m_procFd = ::open(m_root.path("/proc").constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    return m_procFd >= 0;
+}
+
+void GpuClientCollector::reset()
+{
+    m_clients.clear();
+    m_lastNs = 0;
+    if (m_procFd >= 0) {
+        ::close(m_procFd);
+        m_procFd = -1;
+    }
+}
+
+QString GpuClientCollector::processName(int pid)
+{
+    char path[32];
+    std::snprintf(path, sizeof(path), "%d/comm", pid);
+    const int n = readAt(m_procFd, path, m_buffer, sizeof(m_buffer));
+    return n > 0 ? QString::fromUtf8(m_buffer, n).trimmed() : QString();
+}
+
+void GpuClientCollector::readFdinfo(int pid, const char *fd, qint64 elapsedNs)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "%d/fdinfo/%s", pid, fd);
+    const int n = readAt(m_procFd, path, m_buffer, sizeof(m_buffer));
+    if (n <= 0) return;
+
+    QByteArray driver;
+    QByteArray pdev;
+    QByteArray clientId;
+    QHash<QByteArray, Engine> engines;
+    quint64 vramBytes = 0;
+
+    SysParser parser(m_buffer, n);
+    while (!parser.atEnd()) {
+        const char *key;
+        int keyLength;
+        if (!parser.token(key, keyLength) || key[keyLength - 1] != ':') {
+            parser.nextLine();
+            continue;
+        }
+        --keyLength;
+
+        if (equals(key, keyLength, "drm-driver")) {
+            const char *value;
+            int length;
+            if (parser.token(value, length)) driver = QByteArray(value, length);
+        } else if (equals(key, keyLength, "drm-pdev")) {
+            const char *value;
+            int length;
+            if (parser.token(value, length)) pdev = QByteArray(value, length);
+        } else if (equals(key, keyLength, "drm-client-id")) {
+            const char *value;
+            int length;
+            if (parser.token(value, length)) clientId = QByteArray(value, length);
+        } else if (startsWith(key, keyLength, "drm-engine-") && !startsWith(key, keyLength, "drm-engine-capacity-")) {
+            parser.uint64(engines[QByteArray(key + 11, keyLength - 11)].ns);
+        } else if (startsWith(key, keyLength, "drm-cycles-")) {
+            parser.uint64(engines[QByteArray(key + 11, keyLength - 11)].cycles);
+        } else if (startsWith(key, keyLength, "drm-total-cycles-")) {
+            parser.uint64(engines[QByteArray(key + 17, keyLength - 17)].totalCycles);
+        } else if ((startsWith(key, keyLength, "drm-memory-vram") || startsWith(key, keyLength, "drm-resident-vram")
+                    || startsWith(key, keyLength, "drm-resident-local")) && vramBytes == 0) {
+            quint64 amount = 0;
+            const char *unit;
+            int unitLength = 0;
+            if (parser.uint64(amount)) {
+                parser.token(unit, unitLength);
+                if (startsWith(unit, unitLength, "KiB")) amount *= 1024;
+                else if (startsWith(unit, unitLength, "MiB")) amount *= 1024 * 1024;
+                vramBytes = amount;
+            }
+        }
+        parser.nextLine();
+    }
+    if (clientId.isEmpty()) return;
+
+    Client &client = m_clients[pdev + '/' + clientId];
+    // A duplicated descriptor of a client that was already counted.
+    if (client.generation == m_generation) return;
+
+    double busy = 0.0;
+    if (client.generation != 0 && elapsedNs > 0) {
+        for (auto it = engines.cbegin(); it != engines.cend(); ++it) {
+            const Engine previous = client.engines.value(it.key());
+            const Engine &current = it.value();
+            double share = 0.0;
+            if (current.totalCycles > previous.totalCycles) {
+                share = double(current.cycles - qMin(current.cycles, previous.cycles))
+                        / double(current.totalCycles - previous.totalCycles);
+            } else if (current.ns > previous.ns) {
+                share = double(current.ns - previous.ns) / double(elapsedNs);
+            }
+            busy = qMax(busy, qBound(0.0, 100.0 * share, 100.0));
+        }
+    }
+
+    client.pid = pid;
+    client.driver = QString::fromUtf8(driver);
+    client.engines = engines;
+    client.vramBytes = vramBytes;
+    client.busy = busy;
+    client.generation = m_generation;
+}
+
+bool GpuClientCollector::collect(QVariantList &clients)
+{
+    if (!openProc()) return false;
+
+    const qint64 now = monotonicNs();
+    const qint64 elapsedNs = m_lastNs > 0 ? now - m_lastNs : 0;
+    m_lastNs = now;
+    ++m_generation;
+
+    const int procFd = ::dup(m_procFd);
+    if (procFd < 0) return false;
+    DIR *proc = ::fdopendir(procFd);
+    if (!proc) {
+        ::close(procFd);
+        return false;
+    }
+    ::rewinddir(proc);
+
+    while (const dirent *entry = ::readdir(proc)) {
+        const char *name = entry->d_name;
+        if (*name < '1' || *name > '9') continue;
+        int pid = 0;
+        for (; *name >= '0' && *name <= '9'; ++name) pid = pid * 10 + (*name - '0');
+        if (*name != '\0') continue;
+
+        char path[32];
+        std::snprintf(path, sizeof(path), "%d/fd", pid);
+        // Other users' processes are not readable; that is expected.
+        const int fdDirFd = ::openat(m_procFd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fdDirFd < 0) continue;
+        DIR *fds = ::fdopendir(fdDirFd);
+        if (!fds) {
+            ::close(fdDirFd);
+            continue;
+        }
+
+        while (const dirent *fd = ::readdir(fds)) {
+            if (fd->d_name[0] < '0' || fd->d_name[0] > '9') continue;
+            char target[64];
+            const ssize_t length = ::readlinkat(::dirfd(fds), fd->d_name, target, sizeof(target) - 1);
+            if (length <= 0) continue;
+            target[length] = '\0';
+            if (std::strncmp(target, "/dev/dri/", 9) != 0) continue;
+            readFdinfo(pid, fd->d_name, elapsedNs);
+        }
+        ::closedir(fds);
+    }
+    ::closedir(proc);
+
+    QList<const Client *> active;
+    for (auto it = m_clients.begin(); it != m_clients.end();) {
+        if (it->generation != m_generation) {
+            it = m_clients.erase(it);
+        } else {
+            active.append(&it.value());
+            ++it;
+        }
+    }
+
+    const int count = qMin<int>(m_topCount, active.size());
+    std::partial_sort(active.begin(), active.begin() + count, active.end(),
+                      [](const Client *a, const Client *b) { return a->busy > b->busy; });
+
+    clients.clear();
+    for (int i = 0; i < count; ++i) {
+        const Client *client = active[i];
+        clients.append(QVariantMap{
+            {"pid", client->pid},
+            {"name", processName(client->pid)},
+            {"driver", client->driver},
+            {"busy", client->busy},
+            {"vram", static_cast<qint64>(client->vramBytes)}
+        });
+    }
+    return true;
+}
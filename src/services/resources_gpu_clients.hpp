@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QHash>
+#include <QVariantList>
+#include "resources_reader.hpp"
+
+// Per-process GPU usage from the DRM fdinfo keys in /proc/<pid>/fdinfo/<fd>
+// (drm-engine-* nanoseconds, or drm-cycles-* / drm-total-cycles-* on xe,
+// and drm-memory-vram / drm-resident-*). Works the same for amdgpu, i915,
+// xe and any other driver implementing the common fdinfo format.
+//
+// Only descriptors whose /proc/<pid>/fd link points into /dev/dri are read,
+// and each DRM client is counted once even when its fd was duplicated.
+// This walks every process, so it only runs while a consumer asks for it.
+class GpuClientCollector
+{
+public:
+    explicit GpuClientCollector(const SysRoot &root, int topCount = 10);
+    ~GpuClientCollector();
+
+    GpuClientCollector(const GpuClientCollector&) = delete;
+    GpuClientCollector& operator=(const GpuClientCollector&) = delete;
+
+    // {pid, name, driver, busy (%, busiest engine), vram (bytes)} maps,
+    // busiest first.
+    bool collect(QVariantList &clients);
+    void reset();
+
+private:
+    struct Engine {
+        quint64 ns = 0;
+        quint64 cycles = 0;
+        quint64 totalCycles = 0;
+    };
+
+    struct Client {
+        int pid = 0;
+        QString driver;
+        QHash<QByteArray, Engine> engines;
+        quint64 vramBytes = 0;
+        double busy = 0.0;
+        quint64 generation = 0;
+    };
+
+    bool openProc();
+    void readFdinfo(int pid, const char *fd, qint64 elapsedNs);
+    QString processName(int pid);
+
+    SysRoot m_root;
+    int m_topCount;
+    int m_procFd = -1;
+    QHash<QByteArray, Client> m_clients;
+    quint64 m_generation = 0;
+    qint64 m_lastNs = 0;
+    char m_buffer[4096];
+};
@@ -0,0 +1,188 @@
+#include "resources_gpu_drm.hpp"
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QVariantMap>
+#include <algorithm>
+
+namespace {
+constexpr qint64 kRediscoverIntervalMs = 10 * 1000;
+
+QString readText(const QString &path)
+{
+    SysFile file;
+    if (!file.open(QFile::encodeName(path), 512) || !file.read()) return QString();
+    return QString::fromUtf8(file.data(), file.size()).trimmed();
+}
+
+bool openAttribute(SysFile &file, const QString &path)
+{
+    return file.open(QFile::encodeName(path), 64);
+}
+
+QString firstHwmon(const QString &deviceDir)
+{
+    const QStringList hwmons = QDir(deviceDir + "/hwmon").entryList({"hwmon*"}, QDir::Dirs | QDir::NoDotAndDotDot);
+    return hwmons.isEmpty() ? QString() : deviceDir + "/hwmon/" + hwmons.first();
+}
+
+QString ueventValue(const QString &uevent, const QString &key)
+{
+    for (const QString &line : uevent.split('\n')) {
+        if (line.startsWith(key + '=')) return line.mid(key.size() + 1);
+    }
+    return QString();
+}
+}
+
+DrmGpuBackend::DrmGpuBackend(const SysRoot &root, QObject *parent)
+    : GpuBackend(parent)
+    , m_root(root)
+{
+}
+
+void DrmGpuBackend::discover()
+{
+    m_cards.clear();
+    m_stale = false;
+    m_sinceDiscovery.start();
+
+    static const QRegularExpression cardName(QStringLiteral("^card\\d+$"));
+    const QString base = QFile::decodeName(m_root.path("/sys/class/drm"));
+    QStringList cards = QDir(base).entryList({"card*"}, QDir::Dirs | QDir::NoDotAndDotDot);
+    std::sort(cards.begin(), cards.end(), [](const QString &a, const QString &b) {
+        return a.size() != b.size() ? a.size() < b.size() : a < b;
+    });
+
+    for (const QString &entry : std::as_const(cards)) {
+        // cardN-DP-1 and friends are connectors, not GPUs.
+        if (!cardName.match(entry).hasMatch()) continue;
+
+        const QString cardDir = base + '/' + entry;
+        const QString deviceDir = cardDir + "/device";
+        const QString driver = ueventValue(readText(deviceDir + "/uevent"), "DRIVER");
+        if (driver != "amdgpu" && driver != "i915" && driver != "xe") continue;
+
+        Card card;
+        card.driver = driver;
+        const QString deviceId = readText(deviceDir + "/device");
+        const QString hwmon = firstHwmon(deviceDir);
+
+        if (driver == "amdgpu") {
+            card.vendor = QStringLiteral("amd");
+            card.name = readText(deviceDir + "/product_name");
+            if (card.name.isEmpty()) card.name = QStringLiteral("AMD Radeon (%1)").arg(deviceId);
+            if (!openAttribute(card.busy, deviceDir + "/gpu_busy_percent")) continue;
+            openAttribute(card.vramTotal, deviceDir + "/mem_info_vram_total");
+            openAttribute(card.vramUsed, deviceDir + "/mem_info_vram_used");
+            // sclk, in Hz
+            if (!hwmon.isEmpty() && openAttribute(card.frequency, hwmon + "/freq1_input")) {
+                card.frequencyScale = 1e-6;
+            }
+        } else {
+            card.vendor = QStringLiteral("intel");
+            card.name = QStringLiteral("Intel Graphics (%1)").arg(deviceId);
+            if (driver == "i915") {
+                openAttribute(card.frequency, cardDir + "/gt_act_freq_mhz");
+                openAttribute(card.idle, cardDir + "/power/rc6_residency_ms");
+            } else {
+                const QString gt = deviceDir + "/tile0/gt0";
+                openAttribute(card.frequency, gt + "/freq0/act_freq");
+                openAttribute(card.idle, gt + "/gtidle/idle_residency_ms");
+            }
+            if (!card.frequency.isOpen() && !card.idle.isOpen()) continue;
+        }
+
+        if (!hwmon.isEmpty()) {
+            openAttribute(card.temperature, hwmon + "/temp1_input");
+            if (!openAttribute(card.power, hwmon + "/power1_average")) {
+                openAttribute(card.power, hwmon + "/power1_input");
+            }
+            // Discrete Intel cards only expose an energy counter.
+            if (!card.power.isOpen()) openAttribute(card.energy, hwmon + "/energy1_input");
+            if (!openAttribute(card.powerCap, hwmon + "/power1_cap")) {
+                openAttribute(card.powerCap, hwmon + "/power1_max");
+            }
+        }
+
+        m_cards.push_back(std::move(card));
+    }
+}
+
+bool DrmGpuBackend::read(Card &card, QVariantMap &gpu)
+{
+    qint64 elapsedMs = 0;
+    if (card.clock.isValid()) {
+        elapsedMs = card.clock.restart();
+    } else {
+        card.clock.start();
+    }
+
+    quint64 value = 0;
+    double utilization = 0.0;
+    if (card.busy.isOpen()) {
+        if (!card.busy.readUInt(value)) return false;
+        utilization = double(value);
+    } else if (card.idle.isOpen()) {
+        if (!card.idle.readUInt(value)) return false;
+        if (elapsedMs > 0 && card.lastIdleMs > 0 && value >= card.lastIdleMs) {
+            const double idle = double(value - card.lastIdleMs) / double(elapsedMs);
+            utilization = qBound(0.0, 100.0 * (1.0 - idle), 100.0);
+        }
+        card.lastIdleMs = value;
+    }
+
+    double memoryTotal = 0.0, memoryUsed = 0.0;
+    if (card.vramTotal.readUInt(value)) memoryTotal = value / (1024.0 * 1024.0);
+    if (card.vramUsed.readUInt(value)) memoryUsed = value / (1024.0 * 1024.0);
+
+    double temperature = 0.0;
+    qint64 milliCelsius = 0;
+    if (card.temperature.readInt(milliCelsius)) temperature = milliCelsius / 1000.0;
+
+    double power = 0.0;
+    if (card.power.readUInt(value)) {
+        power = value / 1e6;
+    } else if (card.energy.readUInt(value)) {
+        if (elapsedMs > 0 && card.lastEnergyUj > 0 && value >= card.lastEnergyUj) {
+            power = double(value - card.lastEnergyUj) / 1e3 / double(elapsedMs);
+        }
+        card.lastEnergyUj = value;
+    }
+    double powerLimit = 0.0;
+    if (card.powerCap.readUInt(value)) powerLimit = value / 1e6;
+
+    double frequency = 0.0;
+    if (card.frequency.readUInt(value)) frequency = value * card.frequencyScale;
+
+    gpu = QVariantMap{
+        {"name", card.name},
+        {"vendor", card.vendor},
+        {"backend", card.driver},
+        {"temperature", temperature},
+        {"utilization", utilization},
+        {"memory_total", memoryTotal},
+        {"memory_used", memoryUsed},
+        {"power_draw", power},
+        {"power_limit", powerLimit},
+        {"frequency_mhz", frequency}
+    };
+    return true;
+}
+
+void DrmGpuBackend::collect(QVariantList &gpus)
+{
+    if (m_stale && (!m_sinceDiscovery.isValid() || m_sinceDiscovery.elapsed() >= kRediscoverIntervalMs)) {
+        discover();
+    }
+
+    for (Card &card : m_cards) {
+        QVariantMap gpu;
+        if (read(card, gpu)) {
+            gpus.append(gpu);
+        } else {
+            // The card was unbound or reset.
+            m_stale = true;
+        }
+    }
+}
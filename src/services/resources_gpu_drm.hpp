@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <vector>
+#include "resources_gpu.hpp"
+#include "resources_reader.hpp"
+
+// GPUs driven by amdgpu, i915 or xe, read straight from sysfs:
+//
+//   amdgpu  gpu_busy_percent, mem_info_vram_{total,used} and the card's
+//           hwmon (temperature, power, sclk)
+//   i915    gt_act_freq_mhz and the RC6 residency counter, busy being the
+//           share of time the GT was not in RC6
+//   xe      the same through tile0/gt0 freq0/act_freq and gtidle
+//
+// Cards are found once under <root>/sys/class/drm and the attributes stay
+// open; a failed read triggers a new scan a few seconds later.
+class DrmGpuBackend : public GpuBackend
+{
+    Q_OBJECT
+
+public:
+    explicit DrmGpuBackend(const SysRoot &root, QObject *parent = nullptr);
+
+    void collect(QVariantList &gpus) override;
+
+private:
+    struct Card {
+        QString name;
+        QString vendor;
+        QString driver;
+        SysFile busy;
+        SysFile vramTotal;
+        SysFile vramUsed;
+        SysFile temperature;
+        SysFile power;
+        SysFile powerCap;
+        SysFile energy;
+        SysFile frequency;
+        SysFile idle;
+        double frequencyScale = 1.0;
+        quint64 lastIdleMs = 0;
+        quint64 lastEnergyUj = 0;
+        QElapsedTimer clock;
+    };
+
+    void discover();
+    bool read(Card &card, QVariantMap &gpu);
+
+    SysRoot m_root;
+    std::vector<Card> m_cards;
+    QElapsedTimer m_sinceDiscovery;
+    bool m_stale = true;
+};
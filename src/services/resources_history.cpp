@@ -0,0 +1,123 @@
+#include "resources_history.hpp"
+#include <QVariantMap>
+
+HistoryRing::HistoryRing(int resolutionMs, int capacity)
+    : m_resolutionMs(resolutionMs)
+    , m_buckets(size_t(capacity))
+{
+}
+
+void HistoryRing::append(qint64 timestamp, float value)
+{
+    const qint64 slot = timestamp / m_resolutionMs;
+    const int capacity = int(m_buckets.size());
+
+    // A clock that stepped back is folded into the newest bucket as well.
+    if (m_size > 0 && slot <= m_slot) {
+        HistoryBucket &bucket = m_buckets[m_slot % capacity];
+        bucket.min = qMin(bucket.min, value);
+        bucket.max = qMax(bucket.max, value);
+        m_sum += value;
+        ++m_count;
+        bucket.avg = float(m_sum / m_count);
+        bucket.count = m_count;
+        return;
+    }
+
+    if (m_size > 0) {
+        for (qint64 s = qMax(m_slot + 1, slot - capacity + 1); s < slot; ++s) {
+            HistoryBucket &gap = m_buckets[s % capacity];
+            gap = HistoryBucket();
+            gap.timestamp = s * m_resolutionMs;
+        }
+        m_size = int(qMin<qint64>(capacity, m_size + (slot - m_slot)));
+    } else {
+        m_size = 1;
+    }
+
+    HistoryBucket &bucket = m_buckets[slot % capacity];
+    bucket.timestamp = slot * m_resolutionMs;
+    bucket.min = value;
+    bucket.max = value;
+    bucket.avg = value;
+    bucket.count = 1;
+    m_slot = slot;
+    m_sum = value;
+    m_count = 1;
+    m_sequence = quint64(slot) + 1;
+}
+
+void HistoryRing::clear()
+{
+    m_size = 0;
+    m_sequence = 0;
+    m_slot = -1;
+    m_sum = 0.0;
+    m_count = 0;
+}
+
+const HistoryBucket &HistoryRing::bySequence(quint64 sequence) const
+{
+    return m_buckets[sequence % m_buckets.size()];
+}
+
+MetricHistory::MetricHistory()
+    : m_tiers{HistoryRing(1000, 300), HistoryRing(10 * 1000, 360), HistoryRing(60 * 1000, 1440)}
+{
+}
+
+void MetricHistory::append(qint64 timestamp, float value)
+{
+    for (HistoryRing &ring : m_tiers) {
+        ring.append(timestamp, value);
+    }
+}
+
+ResourcesHistory::ResourcesHistory(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ResourcesHistory::append(const QString &metric, qint64 timestamp, float value)
+{
+    m_metrics[metric].append(timestamp, value);
+}
+
+void ResourcesHistory::commit()
+{
+    emit appended();
+}
+
+const HistoryRing *ResourcesHistory::ring(const QString &metric, int tier) const
+{
+    if (tier < 0 || tier >= MetricHistory::TierCount) return nullptr;
+    auto it = m_metrics.constFind(metric);
+    return it == m_metrics.constEnd() ? nullptr : &it->tier(tier);
+}
+
+QStringList ResourcesHistory::metrics() const
+{
+    QStringList names = m_metrics.keys();
+    names.sort();
+    return names;
+}
+
+QVariantList ResourcesHistory::points(const QString &metric, int tier) const
+{
+    QVariantList result;
+    const HistoryRing *history = ring(metric, tier);
+    if (!history) return result;
+
+    result.reserve(history->size());
+    for (quint64 s = history->oldestSequence(); s < history->sequence(); ++s) {
+        const HistoryBucket &bucket = history->bySequence(s);
+        if (bucket.count == 0) continue;
+        result.append(QVariantMap{
+            {"timestamp", bucket.timestamp},
+            {"min", bucket.min},
+            {"max", bucket.max},
+            {"avg", bucket.avg}
+        });
+    }
+    return result;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QVariantList>
+#include <array>
+#include <vector>
+#include <qqml.h>
+
+struct HistoryBucket {
+    qint64 timestamp = 0;
+    float min = 0.0f;
+    float max = 0.0f;
+    float avg = 0.0f;
+    // Samples folded into the bucket; 0 marks a slot nothing was sampled in.
+    int count = 0;
+};
+
+// Fixed-capacity ring of aggregated buckets at one resolution. A sample that
+// falls into the newest bucket's time slot is folded into it in place, so
+// the newest point is always current. Buckets are numbered by their time
+// slot (timestamp / resolution), so the ring always spans capacity *
+// resolution of wall time: slots skipped while sampling was slower, paused
+// or off are kept as empty buckets. Readers use the sequence to pick up only
+// what is new since their last visit.
+class HistoryRing
+{
+public:
+    HistoryRing(int resolutionMs, int capacity);
+
+    void append(qint64 timestamp, float value);
+    void clear();
+
+    int resolutionMs() const { return m_resolutionMs; }
+    int capacity() const { return int(m_buckets.size()); }
+    int size() const { return m_size; }
+
+    // One past the sequence of the newest bucket; size() buckets are kept.
+    quint64 sequence() const { return m_sequence; }
+    quint64 oldestSequence() const { return m_sequence - quint64(m_size); }
+    const HistoryBucket &bySequence(quint64 sequence) const;
+
+private:
+    int m_resolutionMs;
+    std::vector<HistoryBucket> m_buckets;
+    int m_size = 0;
+    quint64 m_sequence = 0;
+    qint64 m_slot = -1;
+    double m_sum = 0.0;
+    int m_count = 0;
+};
+
+// One metric at 1 s for 5 minutes, 10 s for an hour and 1 min for a day.
+class MetricHistory
+{
+public:
+    static constexpr int TierCount = 3;
+
+    MetricHistory();
+
+    void append(qint64 timestamp, float value);
+    const HistoryRing &tier(int tier) const { return m_tiers[tier]; }
+
+private:
+    std::array<HistoryRing, TierCount> m_tiers;
+};
+
+// Named metric histories fed by ResourcesService on every sample. Memory is
+// fixed per metric, and graphs read from here instead of keeping their own
+// arrays.
+class ResourcesHistory : public QObject
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("ResourcesHistory is provided by ResourcesService")
+
+public:
+    enum Tier {
+        Seconds,
+        TenSeconds,
+        Minutes
+    };
+    Q_ENUM(Tier)
+
+    explicit ResourcesHistory(QObject *parent = nullptr);
+
+    void append(const QString &metric, qint64 timestamp, float value);
+    // Signals appended() once after a batch of append() calls.
+    void commit();
+
+    const HistoryRing *ring(const QString &metric, int tier) const;
+
+    Q_INVOKABLE QStringList metrics() const;
+    // Oldest first, as {timestamp, min, max, avg} maps. Slots nothing was
+    // sampled in are left out; the timestamps show the gap.
+    Q_INVOKABLE QVariantList points(const QString &metric, int tier = Seconds) const;
+
+signals:
+    void appended();
+
+private:
+    QHash<QString, MetricHistory> m_metrics;
+};
@@ -0,0 +1,189 @@
+#include "resources_io.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QVariantMap>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr quint64 kSectorBytes = 512;
+}
+
+void DeviceRates::setExclude(const QStringList &globs)
+{
+    m_exclude.clear();
+    for (const QString &glob : globs) {
+        m_exclude.append(QRegularExpression::fromWildcard(glob));
+    }
+    // Filters are applied on first sight; start over so they take effect.
+    reset();
+}
+
+bool DeviceRates::excluded(const QString &name) const
+{
+    for (const QRegularExpression &pattern : m_exclude) {
+        if (pattern.match(name).hasMatch()) return true;
+    }
+    return false;
+}
+
+DeviceRates::Device *DeviceRates::device(const char *name, int length)
+{
+    for (Device &device : m_devices) {
+        if (device.name.size() == length && qstrncmp(device.name.constData(), name, length) == 0) {
+            return &device;
+        }
+    }
+
+    Device device;
+    device.name = QByteArray(name, length);
+    device.label = QString::fromUtf8(device.name);
+    device.included = acceptsNew(device.name);
+    m_devices.push_back(device);
+    return &m_devices.back();
+}
+
+void DeviceRates::update(Device &device, const quint64 (&counters)[3], double elapsedSeconds, bool primed)
+{
+    const bool hasPrevious = device.generation != 0 && primed && elapsedSeconds > 0;
+    for (int i = 0; i < 3; ++i) {
+        device.rates[i] = hasPrevious && counters[i] >= device.counters[i]
+            ? double(counters[i] - device.counters[i]) / elapsedSeconds
+            : 0.0;
+        device.counters[i] = counters[i];
+    }
+    device.generation = m_generation;
+}
+
+void DeviceRates::prune()
+{
+    m_devices.erase(std::remove_if(m_devices.begin(), m_devices.end(), [this](const Device &device) {
+        return device.generation != m_generation;
+    }), m_devices.end());
+}
+
+DiskCollector::DiskCollector(const SysRoot &root)
+    : m_root(root)
+{
+    m_diskstats.open(m_root.path("/proc/diskstats"), 16 * 1024);
+    setExclude({"loop*", "ram*", "zram*", "dm-*"});
+}
+
+bool DiskCollector::acceptsNew(const QByteArray &name) const
+{
+    // Whole disks have an entry in /sys/block; partitions only below it.
+    return !excluded(QString::fromUtf8(name))
+        && QFileInfo::exists(QFile::decodeName(m_root.path("/sys/block/" + name)));
+}
+
+bool DiskCollector::collect(QVariantList &disks)
+{
+    if (!m_diskstats.read()) return false;
+
+    const bool primed = m_clock.isValid();
+    const double elapsed = primed ? m_clock.nsecsElapsed() / 1e9 : 0.0;
+    m_clock.start();
+    ++m_generation;
+
+    // major minor name reads merged sectors ms writes merged sectors ms
+    // in_flight io_ms weighted_ms ...
+    SysParser parser(m_diskstats);
+    while (!parser.atEnd()) {
+        quint64 major = 0, minor = 0;
+        const char *name;
+        int length;
+        quint64 f[10] = {};
+        bool ok = parser.uint64(major) && parser.uint64(minor) && parser.token(name, length);
+        for (int i = 0; ok && i < 10; ++i) ok = parser.uint64(f[i]);
+        parser.nextLine();
+        if (!ok) continue;
+
+        Device *disk = device(name, length);
+        // Reads and writes are in 512-byte sectors, busy time in ms.
+        const quint64 counters[3] = {f[2] * kSectorBytes, f[6] * kSectorBytes, f[9]};
+        update(*disk, counters, elapsed, primed);
+    }
+    prune();
+
+    disks.clear();
+    for (const Device &disk : m_devices) {
+        if (!disk.included) continue;
+        disks.append(QVariantMap{
+            {"name", disk.label},
+            {"read", disk.rates[0]},
+            {"write", disk.rates[1]},
+            // ms of I/O per second of wall time
+            {"busy", qMin(100.0, disk.rates[2] / 10.0)}
+        });
+    }
+    return true;
+}
+
+NetworkCollector::NetworkCollector(const SysRoot &root)
+{
+    m_netdev.open(root.path("/proc/net/dev"), 16 * 1024);
+    setExclude({"lo", "veth*", "docker*", "br-*", "virbr*"});
+}
+
+bool NetworkCollector::acceptsNew(const QByteArray &name) const
+{
+    return !excluded(QString::fromUtf8(name));
+}
+
+bool NetworkCollector::collect(QVariantList &interfaces)
+{
+    if (!m_netdev.read()) return false;
+
+    const bool primed = m_clock.isValid();
+    const double elapsed = primed ? m_clock.nsecsElapsed() / 1e9 : 0.0;
+    m_clock.start();
+    ++m_generation;
+
+    // Two header lines, then "  name: rx_bytes packets errs drop fifo frame
+    // compressed multicast tx_bytes ..."
+    SysParser parser(m_netdev);
+    parser.nextLine();
+    parser.nextLine();
+    while (!parser.atEnd()) {
+        parser.skipSpaces();
+        const char *name;
+        int length;
+        if (!parser.token(name, length)) {
+            parser.nextLine();
+            continue;
+        }
+        // The rx counter can touch the colon ("eth0:123"), so split there.
+        const char *colon = static_cast<const char *>(std::memchr(name, ':', size_t(length)));
+        if (!colon) {
+            parser.nextLine();
+            continue;
+        }
+        const int nameLength = int(colon - name);
+        SysParser counters(colon + 1, length - nameLength - 1);
+        quint64 f[9] = {};
+        bool ok = true;
+        if (counters.uint64(f[0])) {
+            for (int i = 1; ok && i < 9; ++i) ok = parser.uint64(f[i]);
+        } else {
+            for (int i = 0; ok && i < 9; ++i) ok = parser.uint64(f[i]);
+        }
+        parser.nextLine();
+        if (!ok) continue;
+
+        Device *link = device(name, nameLength);
+        const quint64 values[3] = {f[0], f[8], 0};
+        update(*link, values, elapsed, primed);
+    }
+    prune();
+
+    interfaces.clear();
+    for (const Device &link : m_devices) {
+        if (!link.included) continue;
+        interfaces.append(QVariantMap{
+            {"name", link.label},
+            {"rx", link.rates[0]},
+            {"tx", link.rates[1]}
+        });
+    }
+    return true;
+}
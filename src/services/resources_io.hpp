@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVariantList>
+#include <vector>
+#include "resources_reader.hpp"
+
+// Per-device byte counters turned into rates. Devices are matched against
+// the exclude globs once, when they first show up, and are forgotten when
+// they disappear from the file.
+class DeviceRates
+{
+public:
+    virtual ~DeviceRates() = default;
+
+    void setExclude(const QStringList &globs);
+    void reset() { m_devices.clear(); }
+
+protected:
+    struct Device {
+        QByteArray name;
+        QString label;
+        bool included = false;
+        quint64 generation = 0;
+        quint64 counters[3] = {};
+        double rates[3] = {};
+    };
+
+    // Looks up `name` without allocating in the common case.
+    Device *device(const char *name, int length);
+    virtual bool acceptsNew(const QByteArray &name) const = 0;
+
+    // Updates a device's counters; returns per-second deltas once the
+    // device has a previous reading.
+    void update(Device &device, const quint64 (&counters)[3], double elapsedSeconds, bool primed);
+    void prune();
+    bool excluded(const QString &name) const;
+
+    std::vector<Device> m_devices;
+    QList<QRegularExpression> m_exclude;
+    quint64 m_generation = 0;
+    QElapsedTimer m_clock;
+};
+
+// /proc/diskstats: read and write bytes per second and utilisation of
+// whole disks. Partitions are skipped (they are not in /sys/block), as are
+// loop, ram, zram and device-mapper devices unless the filter is changed.
+class DiskCollector : public DeviceRates
+{
+public:
+    explicit DiskCollector(const SysRoot &root);
+
+    // {name, read, write, busy} maps; bytes per second and percent.
+    bool collect(QVariantList &disks);
+
+private:
+    bool acceptsNew(const QByteArray &name) const override;
+
+    SysRoot m_root;
+    SysFile m_diskstats;
+};
+
+// /proc/net/dev: received and transmitted bytes per second per interface.
+// Loopback and common virtual bridges are excluded by default.
+class NetworkCollector : public DeviceRates
+{
+public:
+    explicit NetworkCollector(const SysRoot &root);
+
+    // {name, rx, tx} maps in bytes per second.
+    bool collect(QVariantList &interfaces);
+
+private:
+    bool acceptsNew(const QByteArray &name) const override;
+
+    SysFile m_netdev;
+};
@@ -0,0 +1,55 @@
+#include "resources_memory.hpp"
+#include <QByteArray>
+
+namespace {
+struct Field {
+    const char *key;
+    quint64 MemorySample::*member;
+};
+
+const Field kFields[] = {
+    {"MemTotal:", &MemorySample::total},
+    {"MemAvailable:", &MemorySample::available},
+    {"Buffers:", &MemorySample::buffers},
+    {"Cached:", &MemorySample::cached},
+    {"SwapTotal:", &MemorySample::swapTotal},
+    {"SwapFree:", &MemorySample::swapFree},
+    {"Dirty:", &MemorySample::dirty},
+    {"Writeback:", &MemorySample::writeback},
+};
+}
+
+MemoryCollector::MemoryCollector(const SysRoot &root)
+{
+    m_meminfo.open(root.path("/proc/meminfo"), 8192);
+}
+
+bool MemoryCollector::collect(MemorySample &sample)
+{
+    if (!m_meminfo.read()) return false;
+
+    // Lines are "Key:   value kB", in the order of kFields (which is the
+    // kernel's order), so the field cursor usually matches on the first try.
+    SysParser parser(m_meminfo);
+    size_t next = 0;
+    int found = 0;
+    const size_t fieldCount = sizeof(kFields) / sizeof(kFields[0]);
+    while (!parser.atEnd() && found < int(fieldCount)) {
+        for (size_t i = 0; i < fieldCount; ++i) {
+            const Field &field = kFields[(next + i) % fieldCount];
+            const int length = int(qstrlen(field.key));
+            if (!parser.startsWith(field.key, length)) continue;
+
+            parser.skip(length);
+            quint64 kib = 0;
+            if (parser.uint64(kib)) {
+                sample.*field.member = kib * 1024;
+                ++found;
+            }
+            next = (next + i + 1) % fieldCount;
+            break;
+        }
+        parser.nextLine();
+    }
+    return found > 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QtGlobal>
+#include "resources_reader.hpp"
+
+// Byte counts from /proc/meminfo.
+struct MemorySample {
+    quint64 total = 0;
+    quint64 available = 0;
+    quint64 cached = 0;
+    quint64 buffers = 0;
+    quint64 dirty = 0;
+    quint64 writeback = 0;
+    quint64 swapTotal = 0;
+    quint64 swapFree = 0;
+};
+
+// Reads /proc/meminfo in one pass over a persistent descriptor. Unlike
+// sysinfo(), this reports MemAvailable, the kernel's own estimate of how
+// much can be allocated without swapping.
+class MemoryCollector
+{
+public:
+    explicit MemoryCollector(const SysRoot &root);
+
+    bool collect(MemorySample &sample);
+
+private:
+    SysFile m_meminfo;
+};
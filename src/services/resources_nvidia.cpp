@@ -0,0 +1,146 @@
+#include "resources_nvidia.hpp"
+#include <QStandardPaths>
+
+namespace {
+constexpr int kInitialBackoffMs = 5000;
+constexpr int kMaxBackoffMs = 5 * 60 * 1000;
+constexpr auto kQuery =
+    "--query-gpu=index,name,temperature.gpu,utilization.gpu,memory.total,memory.used,power.draw,power.limit";
+}
+
+NvidiaSmiMonitor::NvidiaSmiMonitor(QObject *parent)
+    : GpuBackend(parent)
+    , m_process(new QProcess(this))
+    , m_retryTimer(new QTimer(this))
+    , m_backoffMs(kInitialBackoffMs)
+{
+    m_process->setReadChannel(QProcess::StandardOutput);
+    m_process->setStandardErrorFile(QProcess::nullDevice());
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &NvidiaSmiMonitor::onReadyRead);
+    connect(m_process, &QProcess::errorOccurred, this, &NvidiaSmiMonitor::onErrorOccurred);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &NvidiaSmiMonitor::onFinished);
+
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &NvidiaSmiMonitor::launch);
+    m_clock.start();
+}
+
+NvidiaSmiMonitor::~NvidiaSmiMonitor()
+{
+    stop();
+}
+
+void NvidiaSmiMonitor::start(int intervalMs)
+{
+    if (m_active && m_intervalMs == intervalMs) return;
+
+    stop();
+    m_intervalMs = intervalMs;
+    m_active = true;
+    m_backoffMs = kInitialBackoffMs;
+    launch();
+}
+
+void NvidiaSmiMonitor::stop()
+{
+    m_active = false;
+    m_retryTimer->stop();
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->kill();
+        m_process->waitForFinished(200);
+    }
+    m_gpus.clear();
+    m_updatedMs.clear();
+}
+
+void NvidiaSmiMonitor::collect(QVariantList &gpus)
+{
+    // A GPU that has not been reported for two loop intervals is gone, or
+    // the child has stalled; either way its last values are stale.
+    const qint64 oldest = m_clock.elapsed() - 2 * qint64(m_intervalMs);
+    for (int i = 0; i < m_gpus.size(); ++i) {
+        if (m_updatedMs[i] < oldest) {
+            m_gpus[i] = QVariantMap();
+        } else if (!m_gpus[i].toMap().isEmpty()) {
+            gpus.append(m_gpus[i]);
+        }
+    }
+    while (!m_gpus.isEmpty() && m_gpus.last().toMap().isEmpty()) {
+        m_gpus.removeLast();
+        m_updatedMs.removeLast();
+    }
+}
+
+void NvidiaSmiMonitor::launch()
+{
+    if (!m_active || m_process->state() != QProcess::NotRunning) return;
+
+    // A PATH lookup is far cheaper than a failed fork/exec on machines
+    // without the NVIDIA driver.
+    const QString program = QStandardPaths::findExecutable("nvidia-smi");
+    if (program.isEmpty()) {
+        scheduleRetry();
+        return;
+    }
+
+    m_process->start(program, {kQuery, "--format=csv,noheader,nounits",
+                               QStringLiteral("--loop-ms=%1").arg(m_intervalMs)});
+}
+
+void NvidiaSmiMonitor::scheduleRetry()
+{
+    m_gpus.clear();
+    m_updatedMs.clear();
+    if (!m_active) return;
+
+    m_retryTimer->start(m_backoffMs);
+    m_backoffMs = qMin(m_backoffMs * 2, kMaxBackoffMs);
+}
+
+void NvidiaSmiMonitor::onReadyRead()
+{
+    while (m_process->canReadLine()) {
+        const QString line = QString::fromLocal8Bit(m_process->readLine()).trimmed();
+        const QStringList fields = line.split(',');
+        if (fields.size() < 8) continue;
+
+        bool ok = false;
+        const int index = fields[0].trimmed().toInt(&ok);
+        if (!ok || index < 0 || index > 64) continue;
+
+        QVariantMap gpu;
+        gpu["index"] = index;
+        gpu["name"] = fields[1].trimmed();
+        gpu["temperature"] = fields[2].trimmed().toDouble();
+        gpu["utilization"] = fields[3].trimmed().toDouble();
+        // QML expects MB for the display text
+        gpu["memory_total"] = fields[4].trimmed().toDouble();
+        gpu["memory_used"] = fields[5].trimmed().toDouble();
+        gpu["power_draw"] = fields[6].trimmed().toDouble();
+        gpu["power_limit"] = fields[7].trimmed().toDouble();
+        gpu["vendor"] = QStringLiteral("nvidia");
+        gpu["backend"] = QStringLiteral("nvidia-smi");
+
+        while (m_gpus.size() <= index) {
+            m_gpus.append(QVariantMap());
+            m_updatedMs.append(0);
+        }
+        m_gpus[index] = gpu;
+        m_updatedMs[index] = m_clock.elapsed();
+        m_backoffMs = kInitialBackoffMs;
+    }
+}
+
+void NvidiaSmiMonitor::onErrorOccurred(QProcess::ProcessError error)
+{
+    // Crashes and exits are reported through finished().
+    if (error == QProcess::FailedToStart) {
+        scheduleRetry();
+    }
+}
+
+void NvidiaSmiMonitor::onFinished()
+{
+    scheduleRetry();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QTimer>
+#include <QVariantList>
+#include "resources_gpu.hpp"
+
+// Streams GPU stats from a single long-running `nvidia-smi --loop-ms` child
+// instead of spawning the tool for every sample. The tool is looked up on
+// PATH (so a fake script can stand in for it); when it is missing or exits,
+// the next attempt is delayed with exponential backoff.
+class NvidiaSmiMonitor : public GpuBackend
+{
+    Q_OBJECT
+
+public:
+    explicit NvidiaSmiMonitor(QObject *parent = nullptr);
+    ~NvidiaSmiMonitor() override;
+
+    void start(int intervalMs) override;
+    void stop() override;
+    void collect(QVariantList &gpus) override;
+
+private slots:
+    void onReadyRead();
+    void onErrorOccurred(QProcess::ProcessError error);
+    void onFinished();
+
+private:
+    void launch();
+    void scheduleRetry();
+
+    QProcess *m_process;
+    QTimer *m_retryTimer;
+    QVariantList m_gpus;
+    // When each entry of m_gpus was last reported, on m_clock.
+    QList<qint64> m_updatedMs;
+    QElapsedTimer m_clock;
+    int m_intervalMs = 2000;
+    int m_backoffMs;
+    bool m_active = false;
+};
@@ -0,0 +1,45 @@
+#include "resources_pressure.hpp"
+
+namespace {
+const char *const kResources[] = {"cpu", "memory", "io"};
+}
+
+PressureCollector::PressureCollector(const SysRoot &root)
+{
+    for (int i = 0; i < ResourceCount; ++i) {
+        m_files[i].open(root.path(QByteArray("/proc/pressure/") + kResources[i]), 256);
+    }
+}
+
+bool PressureCollector::collect(QVariantMap &pressure)
+{
+    bool any = false;
+    for (int i = 0; i < ResourceCount; ++i) {
+        if (!m_files[i].read()) continue;
+
+        // "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456"
+        // "full avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+        double values[6] = {};
+        SysParser parser(m_files[i]);
+        while (!parser.atEnd()) {
+            const int offset = parser.startsWith("some", 4) ? 0 : parser.startsWith("full", 4) ? 3 : -1;
+            if (offset >= 0) {
+                for (int j = 0; j < 3; ++j) {
+                    if (!parser.skipPast('=') || !parser.decimal(values[offset + j])) break;
+                }
+            }
+            parser.nextLine();
+        }
+
+        pressure.insert(QLatin1String(kResources[i]), QVariantMap{
+            {"some10", values[0]},
+            {"some60", values[1]},
+            {"some300", values[2]},
+            {"full10", values[3]},
+            {"full60", values[4]},
+            {"full300", values[5]}
+        });
+        any = true;
+    }
+    return any;
+}
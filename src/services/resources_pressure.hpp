@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QVariantMap>
+#include "resources_reader.hpp"
+
+// Pressure stall information from /proc/pressure/{cpu,memory,io}. Each
+// resource maps to {some10, some60, some300, full10, full60, full300}, the
+// kernel's running averages of the share of time (percent) tasks were
+// stalled. Empty when the kernel has PSI disabled.
+class PressureCollector
+{
+public:
+    explicit PressureCollector(const SysRoot &root);
+
+    bool collect(QVariantMap &pressure);
+
+private:
+    static constexpr int ResourceCount = 3;
+
+    SysFile m_files[ResourceCount];
+};
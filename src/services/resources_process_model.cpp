@@ -0,0 +1,106 @@
+#include "resources_process_model.hpp"
+#include "resources_damped.hpp"
+#include <QSet>
+
+ProcessListModel::ProcessListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int ProcessListModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return m_processes.size();
+}
+
+QVariant ProcessListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_processes.size()) {
+        return {};
+    }
+
+    const ProcessInfo& process = m_processes[index.row()];
+    switch (role) {
+    case PidRole:
+        return process.pid;
+    case Qt::DisplayRole:
+    case NameRole:
+        return process.name;
+    case CpuRole:
+        return process.cpuPercent;
+    case RssRole:
+        return static_cast<qint64>(process.rssBytes);
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> ProcessListModel::roleNames() const {
+    return {
+        {PidRole, "pid"},
+        {NameRole, "name"},
+        {CpuRole, "cpu"},
+        {RssRole, "rss"}
+    };
+}
+
+void ProcessListModel::setEpsilons(float percent, quint64 bytes) {
+    m_percentEpsilon = percent;
+    m_memoryEpsilon = bytes;
+}
+
+void ProcessListModel::update(const QList<ProcessInfo>& processes) {
+    const int oldCount = m_processes.size();
+
+    QSet<int> pids;
+    pids.reserve(processes.size());
+    for (const ProcessInfo& process : processes) pids.insert(process.pid);
+
+    // Bottom up, so the remaining rows keep their indexes.
+    for (int row = m_processes.size() - 1; row >= 0; --row) {
+        if (pids.contains(m_processes[row].pid)) continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_processes.removeAt(row);
+        endRemoveRows();
+    }
+
+    // Rows above `row` already match the new ranking. A process found
+    // further down is moved up, an unknown one inserted; either way only
+    // values that moved past an epsilon are taken over, as in CpuCoreModel.
+    QList<int> roles;
+    for (int row = 0; row < processes.size(); ++row) {
+        const ProcessInfo& next = processes[row];
+        int from = row;
+        while (from < m_processes.size() && m_processes[from].pid != next.pid) ++from;
+
+        if (from == m_processes.size()) {
+            beginInsertRows(QModelIndex(), row, row);
+            m_processes.insert(row, next);
+            endInsertRows();
+            continue;
+        }
+        if (from != row) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_processes.move(from, row);
+            endMoveRows();
+        }
+
+        ProcessInfo& published = m_processes[row];
+        roles.clear();
+        if (published.name != next.name) {
+            published.name = next.name;
+            roles << Qt::DisplayRole << NameRole;
+        }
+        if (movedPast(published.cpuPercent, next.cpuPercent, m_percentEpsilon)) {
+            published.cpuPercent = next.cpuPercent;
+            roles << CpuRole;
+        }
+        if (movedPast(published.rssBytes, next.rssBytes, m_memoryEpsilon)) {
+            published.rssBytes = next.rssBytes;
+            roles << RssRole;
+        }
+        if (!roles.isEmpty()) {
+            emit dataChanged(index(row), index(row), roles);
+        }
+    }
+
+    if (m_processes.size() != oldCount) emit countChanged();
+}
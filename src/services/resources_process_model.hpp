@@ -0,0 +1,40 @@
+#pragma once
+#include <QAbstractListModel>
+#include <qqml.h>
+#include "resources_processes.hpp"
+
+// A ranked list of processes (busiest or largest first). Rows follow
+// processes by pid, so a re-ranking moves rows instead of rewriting them.
+class ProcessListModel : public QAbstractListModel {
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("ProcessListModel is provided by ResourcesService")
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        PidRole = Qt::UserRole + 1,
+        NameRole,
+        CpuRole,
+        RssRole
+    };
+    Q_ENUM(Roles)
+
+    explicit ProcessListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return m_processes.size(); }
+    void update(const QList<ProcessInfo>& processes);
+    void setEpsilons(float percent, quint64 bytes);
+
+signals:
+    void countChanged();
+
+private:
+    QList<ProcessInfo> m_processes;
+    float m_percentEpsilon = 0.0f;
+    quint64 m_memoryEpsilon = 0;
+};
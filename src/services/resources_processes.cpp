@@ -0,0 +1,205 @@
+#include "resources_processes.hpp"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+qint64 monotonicNs()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) clock.start();
+    return clock.nsecsElapsed();
+}
+
+// Keeps the best `limit` entries in a min-heap, so the smallest of the kept
+// entries is the one to beat.
+template <typename Key>
+void offer(QList<QPair<Key, int>> &heap, int limit, Key key, int pid)
+{
+    auto greater = [](const QPair<Key, int> &a, const QPair<Key, int> &b) {
+        return a.first > b.first;
+    };
+    if (heap.size() < limit) {
+        heap.append({key, pid});
+        std::push_heap(heap.begin(), heap.end(), greater);
+    } else if (limit > 0 && key > heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        heap.back() = {key, pid};
+        std::push_heap(heap.begin(), heap.end(), greater);
+    }
+}
+}
+
+ProcessCollector::ProcessCollector(const SysRoot &root, int topCount)
+    : m_root(root)
+    , m_topCount(topCount)
+    , m_ticksPerSecond(sysconf(_SC_CLK_TCK))
+    , m_pageSize(sysconf(_SC_PAGESIZE))
+{
+    m_cpuHeap.reserve(topCount);
+    m_memoryHeap.reserve(topCount);
+}
+
+ProcessCollector::~ProcessCollector()
+{
+    if (m_procFd >= 0) ::close(m_procFd);
+}
+
+bool ProcessCollector::openProc()
+{
+    if (m_procFd >= 0) return true;
+    m_procFd = ::open(m_root.path("/proc").constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    return m_procFd >= 0;
+}
+
+void ProcessCollector::reset()
+{
+    m_table.clear();
+    m_table.squeeze();
+    m_lastNs = 0;
+    if (m_procFd >= 0) {
+        ::close(m_procFd);
+        m_procFd = -1;
+    }
+}
+
+bool ProcessCollector::readStat(int pid, State &state, bool &isNew)
+{
+    char path[32];
+    std::snprintf(path, sizeof(path), "%d/stat", pid);
+    const int fd = ::openat(m_procFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    ssize_t n;
+    do {
+        n = ::pread(fd, m_buffer, sizeof(m_buffer), 0);
+    } while (n < 0 && errno == EINTR);
+    ::close(fd);
+    if (n <= 0) return false;
+
+    // "pid (comm) state ppid ..." where comm may itself contain spaces and
+    // parentheses, so the fields start after the last ')'.
+    const char *begin = static_cast<const char *>(std::memchr(m_buffer, '(', size_t(n)));
+    const char *close = nullptr;
+    for (const char *p = m_buffer + n - 1; p > m_buffer; --p) {
+        if (*p == ')') {
+            close = p;
+            break;
+        }
+    }
+    if (!begin || !close || close < begin) return false;
+
+    SysParser parser(close + 1, int(m_buffer + n - close - 1));
+    const char *token;
+    int length;
+    parser.token(token, length); // state
+
+    // Fields 4..24 (1-based): ppid ... utime(14) stime(15) ... starttime(22) vsize(23) rss(24)
+    quint64 fields[21] = {};
+    for (int i = 0; i < 21; ++i) {
+        qint64 value = 0;
+        if (!parser.int64(value)) return false;
+        fields[i] = quint64(qMax<qint64>(value, 0));
+    }
+    const quint64 ticks = fields[10] + fields[11];
+    const quint64 startTime = fields[18];
+    const quint64 rssPages = fields[20];
+
+    isNew = state.generation == 0 || state.startTime != startTime;
+    if (isNew) {
+        // New pid, or the pid was reused by another process.
+        state = State();
+        state.startTime = startTime;
+        const size_t commLength = qMin<size_t>(size_t(close - begin - 1), sizeof(state.comm) - 1);
+        std::memcpy(state.comm, begin + 1, commLength);
+        state.comm[commLength] = '\0';
+        state.ticks = ticks;
+    }
+
+    state.cpuPercent = 0.0f;
+    if (!isNew && m_elapsedNs > 0 && ticks >= state.ticks) {
+        const double seconds = double(ticks - state.ticks) / double(m_ticksPerSecond);
+        state.cpuPercent = float(100.0 * seconds / (double(m_elapsedNs) / 1e9));
+    }
+    state.ticks = ticks;
+    state.rssBytes = rssPages * quint64(m_pageSize);
+    return true;
+}
+
+bool ProcessCollector::collect(ProcessSample &sample)
+{
+    if (!openProc()) return false;
+
+    // fdopendir() takes ownership of the descriptor it is given.
+    const int dirFd = ::dup(m_procFd);
+    if (dirFd < 0) return false;
+    DIR *dir = ::fdopendir(dirFd);
+    if (!dir) {
+        ::close(dirFd);
+        return false;
+    }
+    ::rewinddir(dir);
+
+    const qint64 now = monotonicNs();
+    m_elapsedNs = m_lastNs > 0 ? now - m_lastNs : 0;
+    m_lastNs = now;
+
+    ++m_generation;
+    m_cpuHeap.clear();
+    m_memoryHeap.clear();
+    int count = 0;
+
+    while (const dirent *entry = ::readdir(dir)) {
+        const char *name = entry->d_name;
+        if (*name < '1' || *name > '9') continue;
+        int pid = 0;
+        for (; *name >= '0' && *name <= '9'; ++name) pid = pid * 10 + (*name - '0');
+        if (*name != '\0') continue;
+
+        State &state = m_table[pid];
+        bool isNew = false;
+        if (!readStat(pid, state, isNew)) {
+            if (state.generation == 0) m_table.remove(pid);
+            continue;
+        }
+        state.generation = m_generation;
+        ++count;
+
+        offer(m_cpuHeap, m_topCount, state.cpuPercent, pid);
+        offer(m_memoryHeap, m_topCount, state.rssBytes, pid);
+    }
+    ::closedir(dir);
+
+    for (auto it = m_table.begin(); it != m_table.end();) {
+        if (it->generation != m_generation) {
+            it = m_table.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    auto toInfo = [this](int pid) {
+        const State &state = *m_table.constFind(pid);
+        ProcessInfo info;
+        info.pid = pid;
+        info.name = QString::fromUtf8(state.comm);
+        info.cpuPercent = state.cpuPercent;
+        info.rssBytes = state.rssBytes;
+        return info;
+    };
+
+    std::sort_heap(m_cpuHeap.begin(), m_cpuHeap.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    std::sort_heap(m_memoryHeap.begin(), m_memoryHeap.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    sample.topCpu.clear();
+    for (const auto &entry : std::as_const(m_cpuHeap)) sample.topCpu.append(toInfo(entry.second));
+    sample.topMemory.clear();
+    for (const auto &entry : std::as_const(m_memoryHeap)) sample.topMemory.append(toInfo(entry.second));
+    sample.processCount = count;
+    return true;
+}
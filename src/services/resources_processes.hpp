@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include "resources_reader.hpp"
+
+struct ProcessInfo {
+    int pid = 0;
+    QString name;
+    float cpuPercent = 0.0f;
+    quint64 rssBytes = 0;
+};
+
+struct ProcessSample {
+    QList<ProcessInfo> topCpu;
+    QList<ProcessInfo> topMemory;
+    int processCount = 0;
+};
+Q_DECLARE_METATYPE(ProcessSample)
+
+// Walks /proc/[pid]/stat once per tick and keeps the N busiest and N largest
+// processes. Per-pid state survives between ticks so CPU time can be turned
+// into a rate; entries for pids that disappeared are pruned after each walk.
+// Everything is read through one /proc directory descriptor and one fixed
+// buffer, and names are only decoded for processes that make a top list.
+class ProcessCollector
+{
+public:
+    explicit ProcessCollector(const SysRoot &root, int topCount = 10);
+    ~ProcessCollector();
+
+    ProcessCollector(const ProcessCollector&) = delete;
+    ProcessCollector& operator=(const ProcessCollector&) = delete;
+
+    bool collect(ProcessSample &sample);
+    // Drops the per-pid table, e.g. when nobody is watching any more.
+    void reset();
+
+    int trackedCount() const { return m_table.size(); }
+
+private:
+    struct State {
+        quint64 startTime = 0;
+        quint64 ticks = 0;
+        quint64 generation = 0;
+        float cpuPercent = 0.0f;
+        quint64 rssBytes = 0;
+        char comm[16] = {};
+    };
+
+    bool openProc();
+    bool readStat(int pid, State &state, bool &isNew);
+
+    SysRoot m_root;
+    int m_topCount;
+    int m_procFd = -1;
+    QHash<int, State> m_table;
+    quint64 m_generation = 0;
+    qint64 m_lastNs = 0;
+    qint64 m_elapsedNs = 0;
+    long m_ticksPerSecond;
+    long m_pageSize;
+    char m_buffer[1024];
+    QList<QPair<float, int>> m_cpuHeap;
+    QList<QPair<quint64, int>> m_memoryHeap;
+};
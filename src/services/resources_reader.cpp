@@ -0,0 +1,104 @@
+#include "resources_reader.hpp"
+#include <QFile>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <utility>
+
+SysRoot::SysRoot(const QString &root)
+    : m_root(QFile::encodeName(root))
+{
+    while (m_root.endsWith('/')) m_root.chop(1);
+}
+
+QByteArray SysRoot::path(const char *relative) const
+{
+    return m_root + relative;
+}
+
+QByteArray SysRoot::path(const QByteArray &relative) const
+{
+    return m_root + relative;
+}
+
+SysFile::~SysFile()
+{
+    close();
+}
+
+SysFile::SysFile(SysFile &&other) noexcept
+    : m_fd(std::exchange(other.m_fd, -1))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_path(std::move(other.m_path))
+    , m_buffer(std::move(other.m_buffer))
+{
+}
+
+SysFile& SysFile::operator=(SysFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_fd = std::exchange(other.m_fd, -1);
+        m_size = std::exchange(other.m_size, 0);
+        m_path = std::move(other.m_path);
+        m_buffer = std::move(other.m_buffer);
+    }
+    return *this;
+}
+
+bool SysFile::open(const QByteArray &path, int capacity)
+{
+    close();
+    m_fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) return false;
+
+    m_path = path;
+    m_buffer.resize(capacity);
+    return true;
+}
+
+void SysFile::close()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_size = 0;
+}
+
+bool SysFile::read()
+{
+    m_size = 0;
+    if (m_fd < 0) return false;
+
+    // procfs regenerates the contents on every read at offset 0, so a single
+    // pread is a fresh sample. Short reads are continued until EOF or the
+    // buffer is full; anything past capacity is not needed by the callers.
+    char *buffer = m_buffer.data();
+    const int capacity = int(m_buffer.size());
+    while (m_size < capacity) {
+        const ssize_t n = ::pread(m_fd, buffer + m_size, size_t(capacity - m_size), off_t(m_size));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            m_size = 0;
+            return false;
+        }
+        if (n == 0) break;
+        m_size += int(n);
+    }
+    return true;
+}
+
+bool SysFile::readUInt(quint64 &value)
+{
+    if (!read()) return false;
+    SysParser parser(*this);
+    return parser.uint64(value);
+}
+
+bool SysFile::readInt(qint64 &value)
+{
+    if (!read()) return false;
+    SysParser parser(*this);
+    return parser.int64(value);
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+// Small reader layer for /proc and /sys. Files stay open between samples and
+// are re-read with pread() into a buffer allocated once, and the parser walks
+// that buffer in place, so reading a file does not touch the heap. The
+// snapshot handed to the GUI thread still does: it is shared across the
+// queued connection, so the sampler's next write to it detaches a copy.
+//
+// Every path is resolved against a root ("" for the live system), which lets
+// the samplers run against a fixture tree laid out like / .
+class SysRoot
+{
+public:
+    explicit SysRoot(const QString &root = QString());
+
+    QByteArray path(const char *relative) const;
+    QByteArray path(const QByteArray &relative) const;
+    const QByteArray &root() const { return m_root; }
+
+private:
+    QByteArray m_root;
+};
+
+class SysFile
+{
+public:
+    SysFile() = default;
+    ~SysFile();
+
+    SysFile(const SysFile&) = delete;
+    SysFile& operator=(const SysFile&) = delete;
+    SysFile(SysFile &&other) noexcept;
+    SysFile& operator=(SysFile &&other) noexcept;
+
+    bool open(const QByteArray &path, int capacity = 4096);
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+    const QByteArray &path() const { return m_path; }
+
+    // Re-reads the file from offset 0. Returns false when the file could not
+    // be read; the previous contents are discarded either way.
+    bool read();
+    const char *data() const { return m_buffer.constData(); }
+    int size() const { return m_size; }
+
+    // Convenience for single-value sysfs attributes.
+    bool readUInt(quint64 &value);
+    bool readInt(qint64 &value);
+
+private:
+    int m_fd = -1;
+    int m_size = 0;
+    QByteArray m_path;
+    QByteArray m_buffer;
+};
+
+// Cursor over a buffer filled by SysFile. Numbers are parsed in place;
+// tokens are returned as pointer/length pairs into the buffer.
+class SysParser
+{
+public:
+    SysParser(const char *data, int size) : m_p(data), m_end(data + size) {}
+    explicit SysParser(const SysFile &file) : SysParser(file.data(), file.size()) {}
+
+    bool atEnd() const { return m_p >= m_end; }
+    bool atEndOfLine() const { return m_p >= m_end || *m_p == '\n'; }
+
+    void skipSpaces()
+    {
+        while (m_p < m_end && (*m_p == ' ' || *m_p == '\t')) ++m_p;
+    }
+
+    void nextLine()
+    {
+        while (m_p < m_end && *m_p != '\n') ++m_p;
+        if (m_p < m_end) ++m_p;
+    }
+
+    bool startsWith(const char *prefix, int length) const
+    {
+        return m_end - m_p >= length && qstrncmp(m_p, prefix, length) == 0;
+    }
+
+    bool token(const char *&begin, int &length)
+    {
+        skipSpaces();
+        begin = m_p;
+        while (m_p < m_end && *m_p != ' ' && *m_p != '\t' && *m_p != '\n') ++m_p;
+        length = int(m_p - begin);
+        return length > 0;
+    }
+
+    // Moves just past the next `c` on the current line.
+    bool skipPast(char c)
+    {
+        while (m_p < m_end && *m_p != c && *m_p != '\n') ++m_p;
+        if (m_p >= m_end || *m_p != c) return false;
+        ++m_p;
+        return true;
+    }
+
+    void skip(int count)
+    {
+        m_p = count < m_end - m_p ? m_p + count : m_end;
+    }
+
+    bool uint64(quint64 &value)
+    {
+        skipSpaces();
+        if (m_p >= m_end || *m_p < '0' || *m_p > '9') return false;
+        quint64 v = 0;
+        while (m_p < m_end && *m_p >= '0' && *m_p <= '9') {
+            v = v * 10 + quint64(*m_p - '0');
+            ++m_p;
+        }
+        value = v;
+        return true;
+    }
+
+    bool int64(qint64 &value)
+    {
+        skipSpaces();
+        const bool negative = m_p < m_end && *m_p == '-';
+        if (negative) ++m_p;
+        quint64 magnitude = 0;
+        if (!uint64(magnitude)) return false;
+        value = negative ? -qint64(magnitude) : qint64(magnitude);
+        return true;
+    }
+
+    // Plain "123" or "123.45"; no exponent.
+    bool decimal(double &value)
+    {
+        skipSpaces();
+        const bool negative = m_p < m_end && *m_p == '-';
+        if (negative) ++m_p;
+        quint64 whole = 0;
+        if (!uint64(whole)) return false;
+        double result = double(whole);
+        if (m_p < m_end && *m_p == '.') {
+            ++m_p;
+            double scale = 0.1;
+            while (m_p < m_end && *m_p >= '0' && *m_p <= '9') {
+                result += (*m_p - '0') * scale;
+                scale *= 0.1;
+                ++m_p;
+            }
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+private:
+    const char *m_p;
+    const char *m_end;
+};
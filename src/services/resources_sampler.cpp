@@ -0,0 +1,232 @@
+#include "resources_sampler.hpp"
+#include "resources_gpu_drm.hpp"
+#include "resources_nvidia.hpp"
+#include <QDebug>
+#include <limits>
+
+ResourcesSampler::ResourcesSampler(const QString &root, QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_root(root)
+    , m_cpu(m_root)
+    , m_memory(m_root)
+    , m_disks(m_root)
+    , m_network(m_root)
+    , m_pressure(m_root)
+    , m_processes(m_root)
+    , m_gpuClients(m_root)
+    , m_sensors(m_root)
+{
+    // Parented to the sampler so they follow it onto the resources thread.
+    m_gpuBackends = {new NvidiaSmiMonitor(this), new DrmGpuBackend(m_root, this)};
+
+    qRegisterMetaType<CpuSample>();
+    qRegisterMetaType<ProcessSample>();
+
+    m_stats = QVariantMap{
+        {"cpu_percent", 0.0},
+        {"cpu_freq_ghz", 0.0},
+        {"cpu_temp", 0.0},
+        {"mem_total", 0},
+        {"mem_available", 0},
+        {"swap_total", 0},
+        {"swap_free", 0},
+        {"mem_cached", 0},
+        {"mem_dirty", 0},
+        {"gpus", QVariantList()},
+        {"gpu_clients", QVariantList()},
+        {"disks", QVariantList()},
+        {"network", QVariantList()},
+        {"pressure", QVariantMap()}
+    };
+
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &ResourcesSampler::wake);
+    m_clock.start();
+}
+
+void ResourcesSampler::setSchedule(const QList<int> &intervals)
+{
+    const qint64 now = m_clock.elapsed();
+    for (int group = 0; group < GroupCount; ++group) {
+        Slot &slot = m_groups[group];
+        const int interval = qMax(0, intervals.value(group));
+        if (interval == slot.intervalMs) continue;
+
+        if (slot.intervalMs == 0) {
+            slot.dueMs = now;
+        } else if (interval > 0) {
+            slot.dueMs = qMin(slot.dueMs, now + interval);
+        }
+        slot.intervalMs = interval;
+
+        if (group == Gpu) {
+            for (GpuBackend *backend : std::as_const(m_gpuBackends)) {
+                if (interval > 0) {
+                    backend->start(interval);
+                } else {
+                    backend->stop();
+                }
+            }
+        } else if (group == Processes && interval == 0) {
+            m_processes.reset();
+            m_processSample = ProcessSample();
+            emit processesSampled(m_processSample);
+        } else if (group == GpuClients && interval == 0) {
+            m_gpuClients.reset();
+            m_gpuClientList.clear();
+            m_stats["gpu_clients"] = m_gpuClientList;
+        } else if (group == Disk && interval == 0) {
+            m_disks.reset();
+        } else if (group == Network && interval == 0) {
+            m_network.reset();
+        }
+    }
+    reschedule();
+}
+
+void ResourcesSampler::stop()
+{
+    setSchedule({});
+}
+
+void ResourcesSampler::setWatchedSensors(const QStringList &ids)
+{
+    m_sensors.setWatched(ids);
+    m_sensorsWatched = !ids.isEmpty();
+    if (!m_sensorsWatched) {
+        m_sensorValues.clear();
+        emit sensorsSampled(m_sensorValues);
+    }
+}
+
+void ResourcesSampler::setDiskExclude(const QStringList &globs)
+{
+    m_disks.setExclude(globs);
+}
+
+void ResourcesSampler::setNetworkExclude(const QStringList &globs)
+{
+    m_network.setExclude(globs);
+}
+
+void ResourcesSampler::reschedule()
+{
+    qint64 next = std::numeric_limits<qint64>::max();
+    for (const Slot &slot : m_groups) {
+        if (slot.intervalMs > 0) next = qMin(next, slot.dueMs);
+    }
+
+    if (next == std::numeric_limits<qint64>::max()) {
+        m_timer->stop();
+        return;
+    }
+    m_timer->start(int(qBound<qint64>(0, next - m_clock.elapsed(), std::numeric_limits<int>::max())));
+}
+
+void ResourcesSampler::wake()
+{
+    const qint64 now = m_clock.elapsed();
+    int groups = 0;
+    for (int group = 0; group < GroupCount; ++group) {
+        Slot &slot = m_groups[group];
+        if (slot.intervalMs == 0) continue;
+        // Anything due within a quarter of its interval rides along with this
+        // wakeup rather than getting one of its own.
+        if (slot.dueMs - now <= slot.intervalMs / 4) {
+            groups |= groupBit(group);
+            slot.dueMs = now + slot.intervalMs;
+        }
+    }
+
+    collect(groups);
+    reschedule();
+}
+
+void ResourcesSampler::collect(int groups)
+{
+    if (groups & groupBit(Cpu)) collectCpu();
+    if (groups & groupBit(Thermal)) collectThermal();
+
+    if (groups & groupBit(Memory)) collectMemory();
+    if ((groups & groupBit(Disk)) && m_disks.collect(m_diskRates)) {
+        m_stats["disks"] = m_diskRates;
+    }
+    if ((groups & groupBit(Network)) && m_network.collect(m_networkRates)) {
+        m_stats["network"] = m_networkRates;
+    }
+    if ((groups & groupBit(Pressure)) && m_pressure.collect(m_pressureSample)) {
+        m_stats["pressure"] = m_pressureSample;
+    }
+
+    if (groups & groupBit(Gpu)) collectGpus();
+    if ((groups & groupBit(GpuClients)) && m_gpuClients.collect(m_gpuClientList)) {
+        m_stats["gpu_clients"] = m_gpuClientList;
+    }
+
+    if (groups & ~groupBit(Processes)) {
+        emit sampled(m_stats, m_cpuSample, groups);
+    }
+
+    if ((groups & groupBit(Processes)) && m_processes.collect(m_processSample)) {
+        emit processesSampled(m_processSample);
+    }
+}
+
+void ResourcesSampler::collectCpu()
+{
+    m_cpu.collect(m_cpuSample);
+
+    double freqSum = 0.0;
+    for (float ghz : std::as_const(m_cpuSample.frequencyGhz)) freqSum += ghz;
+    const int cores = m_cpuSample.coreCount();
+
+    m_stats["cpu_percent"] = double(m_cpuSample.totalUsage);
+    m_stats["cpu_freq_ghz"] = cores > 0 ? freqSum / cores : 0.0;
+}
+
+void ResourcesSampler::collectThermal()
+{
+    if (m_sensors.needsDiscovery()) {
+        m_sensors.discover();
+        emit sensorsDiscovered(m_sensors.describe());
+    }
+
+    m_sensors.readPackageTemps(m_cpuSample.packageTemps);
+    double cpuTemp = 0.0;
+    for (qreal temp : std::as_const(m_cpuSample.packageTemps)) cpuTemp = qMax(cpuTemp, temp);
+    m_stats["cpu_temp"] = cpuTemp;
+
+    if (m_sensorsWatched) {
+        m_sensors.readWatched(m_sensorValues);
+        emit sensorsSampled(m_sensorValues);
+    }
+}
+
+void ResourcesSampler::collectMemory()
+{
+    if (!m_memory.collect(m_memorySample)) {
+        qDebug() << "Failed to read /proc/meminfo";
+        return;
+    }
+
+    m_stats["mem_total"] = static_cast<qint64>(m_memorySample.total);
+    m_stats["mem_available"] = static_cast<qint64>(m_memorySample.available);
+    m_stats["mem_cached"] = static_cast<qint64>(m_memorySample.cached);
+    m_stats["mem_dirty"] = static_cast<qint64>(m_memorySample.dirty);
+    m_stats["swap_total"] = static_cast<qint64>(m_memorySample.swapTotal);
+    m_stats["swap_free"] = static_cast<qint64>(m_memorySample.swapFree);
+}
+
+void ResourcesSampler::collectGpus()
+{
+    QVariantList gpus;
+    for (GpuBackend *backend : std::as_const(m_gpuBackends)) backend->collect(gpus);
+
+    for (int i = 0; i < gpus.size(); ++i) {
+        QVariantMap gpu = gpus[i].toMap();
+        gpu["index"] = i;
+        gpus[i] = gpu;
+    }
+    m_stats["gpus"] = gpus;
+}
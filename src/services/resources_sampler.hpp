@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <QVariantMap>
+#include <array>
+#include "resources_cpu.hpp"
+#include "resources_gpu_clients.hpp"
+#include "resources_io.hpp"
+#include "resources_memory.hpp"
+#include "resources_pressure.hpp"
+#include "resources_processes.hpp"
+#include "resources_sensors.hpp"
+
+class GpuBackend;
+
+// Reads the system stats on the resources thread. Metrics are split into
+// groups that each run at their own interval, and only while the GUI side
+// has asked for them. All groups that are due around the same time share
+// one wakeup; with nothing scheduled the thread does not wake up at all.
+// Each wakeup hands one complete snapshot to the GUI thread, so QML never
+// sees a half-updated set of values.
+class ResourcesSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Group {
+        Cpu,
+        Memory,
+        Thermal,
+        Gpu,
+        Processes,
+        Disk,
+        Network,
+        Pressure,
+        GpuClients,
+        GroupCount
+    };
+
+    explicit ResourcesSampler(const QString &root = QString(), QObject *parent = nullptr);
+
+    static int groupBit(int group) { return 1 << group; }
+
+public slots:
+    // One interval in ms per Group; 0 disables the group.
+    void setSchedule(const QList<int> &intervals);
+    void stop();
+    void setWatchedSensors(const QStringList &ids);
+    void setDiskExclude(const QStringList &globs);
+    void setNetworkExclude(const QStringList &globs);
+
+signals:
+    void sampled(const QVariantMap &stats, const CpuSample &cpu, int groups);
+    void processesSampled(const ProcessSample &processes);
+    void sensorsDiscovered(const QVariantList &sensors);
+    void sensorsSampled(const QVariantMap &values);
+
+private:
+    struct Slot {
+        int intervalMs = 0;
+        qint64 dueMs = 0;
+    };
+
+    void wake();
+    void reschedule();
+    void collect(int groups);
+    void collectCpu();
+    void collectThermal();
+    void collectMemory();
+    void collectGpus();
+
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    std::array<Slot, GroupCount> m_groups;
+    SysRoot m_root;
+    QList<GpuBackend *> m_gpuBackends;
+    QVariantMap m_stats;
+    CpuCollector m_cpu;
+    CpuSample m_cpuSample;
+    MemoryCollector m_memory;
+    MemorySample m_memorySample;
+    DiskCollector m_disks;
+    QVariantList m_diskRates;
+    NetworkCollector m_network;
+    QVariantList m_networkRates;
+    PressureCollector m_pressure;
+    QVariantMap m_pressureSample;
+    ProcessCollector m_processes;
+    ProcessSample m_processSample;
+    GpuClientCollector m_gpuClients;
+    QVariantList m_gpuClientList;
+    SensorCollector m_sensors;
+    QVariantMap m_sensorValues;
+    bool m_sensorsWatched = false;
+};
@@ -0,0 +1,217 @@
+#include "resources_sensors.hpp"
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+constexpr qint64 kRediscoverIntervalMs = 10 * 1000;
+
+QStringList sortedEntries(const QString &path, const QString &pattern)
+{
+    QStringList entries = QDir(path).entryList({pattern}, QDir::Dirs | QDir::NoDotAndDotDot);
+    // hwmon2 before hwmon10
+    std::sort(entries.begin(), entries.end(), [](const QString &a, const QString &b) {
+        return a.size() != b.size() ? a.size() < b.size() : a < b;
+    });
+    return entries;
+}
+
+QString readText(const QByteArray &path)
+{
+    SysFile file;
+    if (!file.open(path, 256) || !file.read()) return QString();
+    return QString::fromUtf8(file.data(), file.size()).trimmed();
+}
+
+bool isCpuDriver(const QString &name)
+{
+    return name == "coretemp" || name == "k10temp" || name == "cpu_thermal" || name == "soc_thermal";
+}
+
+QString uniqueDevice(QHash<QString, int> &seen, const QString &name)
+{
+    const int n = seen[name]++;
+    return n == 0 ? name : QStringLiteral("%1#%2").arg(name).arg(n);
+}
+
+QString kindName(SensorCollector::Kind kind)
+{
+    switch (kind) {
+    case SensorCollector::Temperature: return QStringLiteral("temperature");
+    case SensorCollector::Fan: return QStringLiteral("fan");
+    case SensorCollector::Power: return QStringLiteral("power");
+    case SensorCollector::Voltage: return QStringLiteral("voltage");
+    case SensorCollector::Current: return QStringLiteral("current");
+    }
+    return QString();
+}
+}
+
+SensorCollector::SensorCollector(const SysRoot &root)
+    : m_root(root)
+{
+}
+
+bool SensorCollector::needsDiscovery() const
+{
+    return m_stale && (!m_sinceDiscovery.isValid() || m_sinceDiscovery.elapsed() >= kRediscoverIntervalMs);
+}
+
+void SensorCollector::discover()
+{
+    m_sensors.clear();
+    m_files.clear();
+    discoverHwmon();
+    discoverThermal();
+
+    m_files.resize(m_sensors.size());
+    m_stale = false;
+    m_sinceDiscovery.start();
+    setWatched(m_watchedIds);
+}
+
+void SensorCollector::discoverHwmon()
+{
+    static const QRegularExpression input(QStringLiteral("^(temp|fan|power|in|curr)(\\d+)_(input|average)$"));
+
+    const QString base = QFile::decodeName(m_root.path("/sys/class/hwmon"));
+    QHash<QString, int> seen;
+    for (const QString &dir : sortedEntries(base, QStringLiteral("hwmon*"))) {
+        const QString path = base + '/' + dir;
+        const QString name = readText(QFile::encodeName(path + "/name"));
+        if (name.isEmpty()) continue;
+        const QString device = uniqueDevice(seen, name);
+
+        const QStringList files = QDir(path).entryList(QDir::Files | QDir::System, QDir::Name);
+        for (const QString &file : files) {
+            const QRegularExpressionMatch match = input.match(file);
+            if (!match.hasMatch()) continue;
+
+            const QString type = match.captured(1);
+            const QString stem = type + match.captured(2);
+            // Prefer the instantaneous power reading when both exist.
+            if (match.captured(3) == "average") {
+                if (type != "power" || files.contains(stem + "_input")) continue;
+            }
+
+            Sensor sensor;
+            sensor.id = device + '/' + stem;
+            sensor.device = device;
+            sensor.path = QFile::encodeName(path + '/' + file);
+            sensor.label = readText(QFile::encodeName(path + '/' + stem + "_label"));
+            if (sensor.label.isEmpty()) sensor.label = name + ' ' + stem;
+
+            if (type == "temp") {
+                sensor.kind = Temperature;
+                sensor.scale = 1e-3;
+                sensor.package = isCpuDriver(name) && stem == "temp1";
+            } else if (type == "fan") {
+                sensor.kind = Fan;
+            } else if (type == "power") {
+                sensor.kind = Power;
+                sensor.scale = 1e-6;
+            } else if (type == "in") {
+                sensor.kind = Voltage;
+                sensor.scale = 1e-3;
+            } else {
+                sensor.kind = Current;
+                sensor.scale = 1e-3;
+            }
+            m_sensors.push_back(sensor);
+        }
+    }
+}
+
+void SensorCollector::discoverThermal()
+{
+    const QString base = QFile::decodeName(m_root.path("/sys/class/thermal"));
+    QHash<QString, int> seen;
+    for (const QString &dir : sortedEntries(base, QStringLiteral("thermal_zone*"))) {
+        const QString path = base + '/' + dir;
+        const QString type = readText(QFile::encodeName(path + "/type"));
+        if (type.isEmpty() || !QFile::exists(path + "/temp")) continue;
+
+        Sensor sensor;
+        sensor.device = QStringLiteral("thermal");
+        sensor.id = sensor.device + '/' + uniqueDevice(seen, type);
+        sensor.label = type;
+        sensor.kind = Temperature;
+        sensor.scale = 1e-3;
+        sensor.path = QFile::encodeName(path + "/temp");
+        m_sensors.push_back(sensor);
+    }
+}
+
+QVariantList SensorCollector::describe() const
+{
+    QVariantList result;
+    result.reserve(int(m_sensors.size()));
+    for (const Sensor &sensor : m_sensors) {
+        result.append(QVariantMap{
+            {"id", sensor.id},
+            {"device", sensor.device},
+            {"label", sensor.label},
+            {"kind", kindName(sensor.kind)}
+        });
+    }
+    return result;
+}
+
+void SensorCollector::setWatched(const QStringList &ids)
+{
+    m_watchedIds = ids;
+    m_packages.clear();
+    m_watched.clear();
+    for (int i = 0; i < int(m_sensors.size()); ++i) {
+        if (m_sensors[i].package) m_packages.push_back(i);
+        if (ids.contains(m_sensors[i].id)) m_watched.push_back(i);
+    }
+    openSelected();
+}
+
+void SensorCollector::openSelected()
+{
+    std::vector<bool> wanted(m_sensors.size(), false);
+    for (int i : m_packages) wanted[i] = true;
+    for (int i : m_watched) wanted[i] = true;
+
+    for (int i = 0; i < int(m_sensors.size()); ++i) {
+        if (!wanted[i]) {
+            m_files[i].close();
+        } else if (!m_files[i].isOpen() && !m_files[i].open(m_sensors[i].path, 32)) {
+            m_stale = true;
+        }
+    }
+}
+
+bool SensorCollector::readSensor(int index, double &value)
+{
+    qint64 raw = 0;
+    if (!m_files[index].readInt(raw)) {
+        // The device went away or was renumbered.
+        m_stale = true;
+        return false;
+    }
+    value = double(raw) * m_sensors[index].scale;
+    return true;
+}
+
+void SensorCollector::readPackageTemps(QList<qreal> &temps)
+{
+    temps.clear();
+    for (int i : m_packages) {
+        double value = 0.0;
+        if (readSensor(i, value) && value > 0) temps.append(value);
+    }
+}
+
+void SensorCollector::readWatched(QVariantMap &values)
+{
+    values.clear();
+    for (int i : m_watched) {
+        double value = 0.0;
+        if (readSensor(i, value)) values.insert(m_sensors[i].id, value);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+#include <vector>
+#include "resources_reader.hpp"
+
+// Index of every hwmon input (temperatures, fans, power, voltage, current)
+// and thermal zone. The sysfs tree is walked once; after that a tick only
+// preads the CPU package sensors and whichever sensors are watched, each
+// through a descriptor that stays open. A failed read marks the index stale
+// and it is rebuilt on a later tick, at most every few seconds.
+//
+// Sensor ids are "<device>/<input>", e.g. "k10temp/temp1" or
+// "thermal/acpitz"; repeated device names get a "#n" suffix in hwmon order.
+class SensorCollector
+{
+public:
+    enum Kind {
+        Temperature,
+        Fan,
+        Power,
+        Voltage,
+        Current
+    };
+
+    explicit SensorCollector(const SysRoot &root);
+
+    bool needsDiscovery() const;
+    void discover();
+
+    // Description of every sensor, as {id, device, label, kind} maps.
+    QVariantList describe() const;
+
+    void setWatched(const QStringList &ids);
+    void readPackageTemps(QList<qreal> &temps);
+    void readWatched(QVariantMap &values);
+
+private:
+    struct Sensor {
+        QString id;
+        QString device;
+        QString label;
+        Kind kind = Temperature;
+        QByteArray path;
+        double scale = 1.0;
+        bool package = false;
+    };
+
+    void discoverHwmon();
+    void discoverThermal();
+    void openSelected();
+    bool readSensor(int index, double &value);
+
+    SysRoot m_root;
+    std::vector<Sensor> m_sensors;
+    std::vector<SysFile> m_files;
+    std::vector<int> m_packages;
+    std::vector<int> m_watched;
+    QStringList m_watchedIds;
+    QElapsedTimer m_sinceDiscovery;
+    bool m_stale = true;
+};
@@ -0,0 +1,178 @@
+#include "resources_sparkline.hpp"
+#include <QMatrix4x4>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+
+namespace {
+// Samples at most this many slots apart are joined by a line, so a tier
+// finer than the sampling interval still draws one; longer gaps (pauses,
+// groups switched off) stay open.
+constexpr quint64 kBridgeSlots = 16;
+}
+
+Sparkline::Sparkline(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+void Sparkline::setHistory(ResourcesHistory *history) {
+    if (m_history == history) return;
+    if (m_history) disconnect(m_history, nullptr, this, nullptr);
+    m_history = history;
+    if (m_history) connect(m_history, &ResourcesHistory::appended, this, &QQuickItem::update);
+    rebuild();
+    emit historyChanged();
+}
+
+void Sparkline::setMetric(const QString &metric) {
+    if (m_metric == metric) return;
+    m_metric = metric;
+    rebuild();
+    emit metricChanged();
+}
+
+void Sparkline::setTier(int tier) {
+    if (m_tier == tier) return;
+    m_tier = tier;
+    rebuild();
+    emit tierChanged();
+}
+
+void Sparkline::setColor(const QColor &color) {
+    if (m_color == color) return;
+    m_color = color;
+    m_colorDirty = true;
+    update();
+    emit colorChanged();
+}
+
+void Sparkline::setMinimum(qreal minimum) {
+    if (qFuzzyCompare(m_minimum, minimum)) return;
+    m_minimum = minimum;
+    update();
+    emit rangeChanged();
+}
+
+void Sparkline::setMaximum(qreal maximum) {
+    if (qFuzzyCompare(m_maximum, maximum)) return;
+    m_maximum = maximum;
+    update();
+    emit rangeChanged();
+}
+
+void Sparkline::rebuild() {
+    m_rebuild = true;
+    update();
+}
+
+QSGNode *Sparkline::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) {
+    const HistoryRing *ring = m_history ? m_history->ring(m_metric, m_tier) : nullptr;
+    // Rebase well before the bucket offsets lose float precision.
+    if (m_rebuild || !ring || ring->capacity() < 2 || ring->sequence() - m_base > (1u << 22)) {
+        delete oldNode;
+        oldNode = nullptr;
+        m_rebuild = false;
+    }
+    if (!ring || ring->capacity() < 2 || ring->size() == 0 || width() <= 0 || height() <= 0) {
+        delete oldNode;
+        // Start from scratch once there is something to draw again.
+        m_rebuild = true;
+        return nullptr;
+    }
+
+    const int capacity = ring->capacity();
+    auto *transform = static_cast<QSGTransformNode *>(oldNode);
+    QSGGeometryNode *line = nullptr;
+    if (!transform) {
+        transform = new QSGTransformNode;
+        line = new QSGGeometryNode;
+
+        // One segment per bucket, from the previous bucket's point to its own,
+        // stored at the bucket's ring slot. DrawLines does not care about the
+        // order of segments, so the slots never have to be shifted.
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), capacity * 2);
+        geometry->setDrawingMode(QSGGeometry::DrawLines);
+        geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+        QSGGeometry::Point2D *v = geometry->vertexDataAsPoint2D();
+        for (int i = 0; i < capacity * 2; ++i) v[i].set(0, 0);
+        line->setGeometry(geometry);
+        line->setFlag(QSGNode::OwnsGeometry);
+
+        line->setMaterial(new QSGFlatColorMaterial);
+        line->setFlag(QSGNode::OwnsMaterial);
+        transform->appendChildNode(line);
+
+        m_base = ring->oldestSequence();
+        m_next = m_base;
+        m_colorDirty = true;
+    } else {
+        line = static_cast<QSGGeometryNode *>(transform->firstChild());
+    }
+
+    if (m_colorDirty) {
+        static_cast<QSGFlatColorMaterial *>(line->material())->setColor(m_color);
+        line->markDirty(QSGNode::DirtyMaterial);
+        m_colorDirty = false;
+    }
+
+    const quint64 oldest = ring->oldestSequence();
+    const quint64 end = ring->sequence();
+    QSGGeometry::Point2D *v = line->geometry()->vertexDataAsPoint2D();
+    auto pointAt = [&](quint64 s) {
+        return QPointF(double(s - m_base), ring->bySequence(s).avg);
+    };
+    auto setSegment = [&](quint64 s, const QPointF &a, const QPointF &b) {
+        QSGGeometry::Point2D *segment = v + (s % capacity) * 2;
+        if (segment[0].x == float(a.x()) && segment[0].y == float(a.y())
+            && segment[1].x == float(b.x()) && segment[1].y == float(b.y())) {
+            return false;
+        }
+        segment[0].set(float(a.x()), float(a.y()));
+        segment[1].set(float(b.x()), float(b.y()));
+        return true;
+    };
+
+    // Each filled bucket's segment starts at the closest filled bucket
+    // before it; empty buckets collapse to a point. The newest bucket may
+    // have been updated in place since the last frame, so its segment is
+    // rewritten along with the new ones.
+    const quint64 from = m_next > oldest ? m_next - 1 : oldest;
+    bool dirty = false;
+    for (quint64 s = from; s < end; ++s) {
+        const QPointF b = pointAt(s);
+        QPointF a = b;
+        if (ring->bySequence(s).count > 0) {
+            for (quint64 p = s; p > oldest && s - p < kBridgeSlots;) {
+                --p;
+                if (ring->bySequence(p).count > 0) {
+                    a = pointAt(p);
+                    break;
+                }
+            }
+        }
+        dirty |= setSegment(s, a, b);
+    }
+    // Segments near the old end may still reach back to evicted buckets;
+    // collapse those to their own point.
+    const double oldestX = double(oldest - m_base);
+    for (quint64 s = oldest; s < end && s < oldest + kBridgeSlots; ++s) {
+        const QPointF b = pointAt(s);
+        if ((v + (s % capacity) * 2)[0].x < float(oldestX)) {
+            dirty |= setSegment(s, b, b);
+        }
+    }
+    m_next = end;
+    if (dirty) line->markDirty(QSGNode::DirtyGeometry);
+
+    // Newest bucket on the right edge, capacity - 1 buckets across the width.
+    const qreal range = m_maximum > m_minimum ? m_maximum - m_minimum : 1.0;
+    QMatrix4x4 matrix;
+    matrix.translate(0, height());
+    matrix.scale(width() / (capacity - 1), -height() / range);
+    matrix.translate(-(double(end - 1 - m_base) - (capacity - 1)), -m_minimum);
+    transform->setMatrix(matrix);
+
+    return transform;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <QColor>
+#include <QPointer>
+#include <QtQuick/QQuickItem>
+#include <QtQml/qqmlregistration.h>
+#include "resources_history.hpp"
+
+// Scene-graph line graph over one ResourcesHistory tier. Each bucket owns a
+// fixed segment slot in the vertex buffer and the scrolling is done by the
+// transform node, so a repaint only rewrites the segments of buckets that
+// arrived (or were folded into) since the previous frame.
+class Sparkline : public QQuickItem {
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(ResourcesHistory* history READ history WRITE setHistory NOTIFY historyChanged)
+    Q_PROPERTY(QString metric READ metric WRITE setMetric NOTIFY metricChanged)
+    Q_PROPERTY(int tier READ tier WRITE setTier NOTIFY tierChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(qreal minimum READ minimum WRITE setMinimum NOTIFY rangeChanged)
+    Q_PROPERTY(qreal maximum READ maximum WRITE setMaximum NOTIFY rangeChanged)
+
+public:
+    explicit Sparkline(QQuickItem *parent = nullptr);
+
+    ResourcesHistory *history() const { return m_history; }
+    void setHistory(ResourcesHistory *history);
+    QString metric() const { return m_metric; }
+    void setMetric(const QString &metric);
+    int tier() const { return m_tier; }
+    void setTier(int tier);
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color);
+    qreal minimum() const { return m_minimum; }
+    void setMinimum(qreal minimum);
+    qreal maximum() const { return m_maximum; }
+    void setMaximum(qreal maximum);
+
+signals:
+    void historyChanged();
+    void metricChanged();
+    void tierChanged();
+    void colorChanged();
+    void rangeChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    void rebuild();
+
+    QPointer<ResourcesHistory> m_history;
+    QString m_metric;
+    int m_tier = ResourcesHistory::Seconds;
+    QColor m_color = Qt::white;
+    qreal m_minimum = 0.0;
+    qreal m_maximum = 100.0;
+
+    // Render-thread state, only touched from updatePaintNode().
+    bool m_rebuild = true;
+    bool m_colorDirty = true;
+    quint64 m_base = 0;
+    quint64 m_next = 0;
+};
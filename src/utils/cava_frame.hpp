@@ -0,0 +1,95 @@
+#pragma once
+#include <QtGlobal>
+#include <cstring>
+#include <vector>
+
+// Reassembles cava's raw binary output into whole frames. Reads from the
+// pipe can end anywhere inside a frame, so the tail of each read is kept
+// until the rest of its frame arrives. Only the newest complete frame is
+// kept; frames replaced before takeFrame() saw them are counted as dropped.
+class CavaFrameAssembler {
+public:
+    // bytesPerBar is 1 for cava's "8bit" bit_format and 2 for "16bit".
+    CavaFrameAssembler(int barCount, int bytesPerBar) {
+        configure(barCount, bytesPerBar);
+    }
+
+    void configure(int barCount, int bytesPerBar) {
+        m_barCount = barCount;
+        m_bytesPerBar = bytesPerBar == 1 ? 1 : 2;
+        m_frameSize = m_barCount * m_bytesPerBar;
+        m_pending.assign(m_frameSize, 0);
+        m_frame.assign(m_frameSize, 0);
+        reset();
+    }
+
+    void reset() {
+        m_pendingSize = 0;
+        m_dropped = 0;
+        m_fresh = false;
+    }
+
+    int barCount() const { return m_barCount; }
+    int bytesPerBar() const { return m_bytesPerBar; }
+    int frameSize() const { return m_frameSize; }
+    quint64 droppedFrames() const { return m_dropped; }
+
+    // Returns true when the data completed at least one frame.
+    bool push(const char *data, qint64 size) {
+        if (m_frameSize == 0 || size <= 0) return false;
+
+        const qint64 total = m_pendingSize + size;
+        const qint64 frames = total / m_frameSize;
+        const qint64 leftover = total % m_frameSize;
+
+        if (frames == 0) {
+            std::memcpy(m_pending.data() + m_pendingSize, data, size_t(size));
+            m_pendingSize = int(total);
+            return false;
+        }
+
+        // Offset of the newest complete frame in pending + data.
+        const qint64 start = (frames - 1) * m_frameSize;
+        if (start >= m_pendingSize) {
+            std::memcpy(m_frame.data(), data + (start - m_pendingSize), size_t(m_frameSize));
+        } else {
+            const int head = m_pendingSize - int(start);
+            std::memcpy(m_frame.data(), m_pending.data() + start, size_t(head));
+            std::memcpy(m_frame.data() + head, data, size_t(m_frameSize - head));
+        }
+        m_dropped += quint64(frames - 1) + (m_fresh ? 1 : 0);
+        m_fresh = true;
+
+        std::memcpy(m_pending.data(), data + size - leftover, size_t(leftover));
+        m_pendingSize = int(leftover);
+        return true;
+    }
+
+    // True once per newly completed frame.
+    bool takeFrame() {
+        const bool fresh = m_fresh;
+        m_fresh = false;
+        return fresh;
+    }
+
+    // Bar value of the newest frame, scaled to the 16-bit range so both
+    // formats read the same.
+    quint16 bar(int index) const {
+        if (m_bytesPerBar == 1) {
+            return quint16(quint8(m_frame[index]) * 257);
+        }
+        quint16 value;
+        std::memcpy(&value, m_frame.data() + index * 2, sizeof(value));
+        return value;
+    }
+
+private:
+    std::vector<char> m_pending;
+    std::vector<char> m_frame;
+    int m_pendingSize = 0;
+    int m_barCount = 0;
+    int m_bytesPerBar = 2;
+    int m_frameSize = 0;
+    quint64 m_dropped = 0;
+    bool m_fresh = false;
+};
@@ -1,7 +1,24 @@
 #include "cava_watcher.hpp"
 #include <algorithm>
+#include <QFile>
 #include <QUrl>
 
+namespace {
+// Returns 8 or 16 from the [output] bit_format line, 0 when it is not set.
+int configBitFormat(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (!line.startsWith("bit_format")) continue;
+        const QByteArray value = line.mid(line.indexOf('=') + 1).trimmed();
+        if (value.startsWith("8bit")) return 8;
+        if (value.startsWith("16bit")) return 16;
+    }
+    return 0;
+}
+}
+
 CavaWatcher::CavaWatcher(QObject *parent)
     : QObject(parent)
     , m_process(new QProcess(this))
@@ -19,6 +36,16 @@ CavaWatcher::CavaWatcher(QObject *parent)
     m_previousWeights.assign(m_barCount, 0.0);
 }
 
+void CavaWatcher::setBitFormat(int bits) {
+    const int bytesPerBar = bits == 8 ? 1 : 2;
+    if (bytesPerBar == m_frames.bytesPerBar()) return;
+
+    const bool hadDrops = m_frames.droppedFrames() > 0;
+    m_frames.configure(m_barCount, bytesPerBar);
+    emit bitFormatChanged();
+    if (hadDrops) emit droppedFramesChanged();
+}
+
 void CavaWatcher::setActive(bool a) {
     if (m_active == a) return;
 
@@ -52,8 +79,13 @@ void CavaWatcher::setActive(bool a) {
         QStringList args;
         if (!configPath.isEmpty()) {
             args << "-p" << configPath;
+            if (const int bits = configBitFormat(configPath)) setBitFormat(bits);
         }
 
+        const bool hadDrops = m_frames.droppedFrames() > 0;
+        m_frames.reset();
+        if (hadDrops) emit droppedFramesChanged();
+
         m_process->start("cava", args);
 
         if (!m_process->waitForStarted(1000)) {
@@ -76,16 +108,15 @@ void CavaWatcher::setActive(bool a) {
 void CavaWatcher::onReadyRead() {
     if (!m_active) return;
 
-    QByteArray rawBytes = m_process->readAllStandardOutput();
-    const int frameSize = m_barCount * sizeof(uint16_t);
-
-    // Skip incomplete frames
-    if (rawBytes.size() < frameSize) return;
-
-    // Only process the latest frame, discard old buffered data
-    const uint16_t* samples = reinterpret_cast<const uint16_t*>(
-        rawBytes.constData() + rawBytes.size() - frameSize
-    );
+    // Drain the pipe through a fixed buffer; the assembler keeps partial
+    // frames between reads.
+    const quint64 dropped = m_frames.droppedFrames();
+    qint64 n;
+    while ((n = m_process->read(m_readBuffer, sizeof(m_readBuffer))) > 0) {
+        m_frames.push(m_readBuffer, n);
+    }
+    if (m_frames.droppedFrames() != dropped) emit droppedFramesChanged();
+    if (!m_frames.takeFrame()) return;
 
     // Pre-calculate smoothing factor
     const double smoothFactor = 1.0 / (m_smoothing + 1.0);
@@ -93,8 +124,8 @@ void CavaWatcher::onReadyRead() {
 
     // In-place update to avoid allocation
     for (int i = 0; i < m_barCount; ++i) {
-        // Scale down from uint16_t (0-65535) to reasonable range
-        double rawVal = samples[i] / 32.0;
+        // Scale down from the 16-bit range (0-65535) to reasonable range
+        double rawVal = m_frames.bar(i) / 32.0;
 
         // Single-pass temporal smoothing
         double val = (rawVal * smoothFactor) + (m_previousWeights[i] * inverseFactor);
@@ -6,6 +6,7 @@
 #include <QDebug>
 #include <vector>
 #include <QtQml/qqmlregistration.h>
+#include "cava_frame.hpp"
 
 class CavaWatcher : public QObject {
     Q_OBJECT
@@ -15,6 +16,9 @@ class CavaWatcher : public QObject {
     Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
     Q_PROPERTY(int barCount READ barCount CONSTANT)
     Q_PROPERTY(QString configPath READ configPath WRITE setConfigPath NOTIFY configPathChanged)
+    // 8 or 16, matching cava's bit_format. Picked up from the config on start.
+    Q_PROPERTY(int bitFormat READ bitFormat WRITE setBitFormat NOTIFY bitFormatChanged)
+    Q_PROPERTY(qint64 droppedFrames READ droppedFrames NOTIFY droppedFramesChanged)
 
 public:
     explicit CavaWatcher(QObject *parent = nullptr);
@@ -34,6 +38,10 @@ public:
     void setActive(bool a);
     int barCount() const { return m_barCount; }
 
+    int bitFormat() const { return m_frames.bytesPerBar() * 8; }
+    void setBitFormat(int bits);
+    qint64 droppedFrames() const { return qint64(m_frames.droppedFrames()); }
+
     QString configPath() const { return m_configPath; }
     void setConfigPath(const QString& path) {
         if (m_configPath != path) {
@@ -52,6 +60,8 @@ signals:
     void smoothingChanged();
     void activeChanged();
     void configPathChanged();
+    void bitFormatChanged();
+    void droppedFramesChanged();
 
 private slots:
     void onReadyRead();
@@ -61,6 +71,8 @@ private slots:
 private:
     static const int m_barCount = 30;
     QProcess *m_process;
+    CavaFrameAssembler m_frames{m_barCount, 2};
+    char m_readBuffer[4096];
     QList<double> m_data;
     std::vector<double> m_previousWeights;
     QString m_configPath;